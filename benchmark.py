@@ -0,0 +1,673 @@
+#!/usr/bin/env python3
+"""
+Benchmark Script
+Sunucuyu verilen ayarlarla kendisi başlatır, yük üretir ve sunucu
+tarafında harcanan CPU süresini, sistem çağrısı ve bellek ayırma
+sayılarını ölçer. Sayaçlar için küçük bir LD_PRELOAD kitaplığı derlenir
+(cc gerekir).
+
+  ./benchmark.py idle [-b ./ircserv] [--counts 1000,10000,50000]
+  ./benchmark.py quit [-b eski/ircserv -b ./ircserv] [--channels 20 --peers 50]
+  ./benchmark.py fanout [-b eski/ircserv -b ./ircserv] [--members 1000]
+  ./benchmark.py parser [-b eski/ircserv -b ./ircserv] [--rounds 200000]
+  ./benchmark.py reply [-b eski/ircserv -b ./ircserv] [--rounds 100000]
+  ./benchmark.py workers [--workers 1,2,4,8] [--clients 200]
+  ./benchmark.py uring [--backends poll,epoll,io_uring] [--clients 200]
+
+Birden fazla -b verilirse (ör. eski ve yeni derleme) her ikili aynı yük
+altında ölçülür ve sonuçlar yan yana basılır.
+"""
+
+import argparse
+import mmap
+import os
+import resource
+import selectors
+import socket
+import struct
+import subprocess
+import sys
+import tempfile
+import time
+
+PASSWORD = 'bench'
+
+# Sunucunun çağırdığı sarmalayıcıları sayar; glibc içi çağrılar sayılmaz
+SHIM_SOURCE = r"""
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+enum { MALLOCS, MALLOC_BYTES, SYSCALLS, WAITS, RECEIVES, SENDS, SENT_BYTES, URING_ENTERS, COPIED_BYTES, COUNTERS };
+
+static unsigned long fallback[COUNTERS];
+static unsigned long *counters = fallback;
+
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void __libc_free(void *pointer);
+
+__attribute__((constructor)) static void setup(void)
+{
+	const char *path = getenv("BENCH_COUNTERS");
+	if (!path)
+		return;
+	int fd = open(path, O_RDWR);
+	if (fd < 0)
+		return;
+	void *map = mmap(NULL, sizeof(fallback), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map != MAP_FAILED)
+		counters = map;
+}
+
+#define COUNT(index, amount) __sync_fetch_and_add(&counters[index], (amount))
+#define REAL(name) \
+	static __typeof__(name) *real; \
+	if (!real) \
+		real = (__typeof__(name) *)dlsym(RTLD_NEXT, #name); \
+	COUNT(SYSCALLS, 1)
+
+void *malloc(size_t size) { COUNT(MALLOCS, 1); COUNT(MALLOC_BYTES, size); return __libc_malloc(size); }
+void *calloc(size_t count, size_t size) { COUNT(MALLOCS, 1); COUNT(MALLOC_BYTES, count * size); return __libc_calloc(count, size); }
+void *realloc(void *pointer, size_t size) { COUNT(MALLOCS, 1); COUNT(MALLOC_BYTES, size); return __libc_realloc(pointer, size); }
+void free(void *pointer) { __libc_free(pointer); }
+
+// Çağrı olarak derlenen kopyalar sayılır; dlsym çözülürken bayt bayt kopyalanır
+static void *copy(const char *name, void **real, void *target, const void *source, size_t length)
+{
+	static volatile int resolving;
+	COUNT(COPIED_BYTES, length);
+	if (!*real && !resolving)
+	{
+		resolving = 1;
+		*real = dlsym(RTLD_NEXT, name);
+		resolving = 0;
+	}
+	if (*real)
+		return ((void *(*)(void *, const void *, size_t))*real)(target, source, length);
+	unsigned char *to = target;
+	const unsigned char *from = source;
+	if (to < from)
+		for (size_t i = 0; i < length; ++i)
+			to[i] = from[i];
+	else
+		for (size_t i = length; i > 0; --i)
+			to[i - 1] = from[i - 1];
+	return target;
+}
+
+void *memcpy(void *target, const void *source, size_t length) { static void *real; return copy("memcpy", &real, target, source, length); }
+void *memmove(void *target, const void *source, size_t length) { static void *real; return copy("memmove", &real, target, source, length); }
+
+static ssize_t sent(ssize_t result) { if (result > 0) COUNT(SENT_BYTES, result); return result; }
+
+int poll(struct pollfd *fds, nfds_t count, int timeout) { REAL(poll); COUNT(WAITS, 1); return real(fds, count, timeout); }
+int epoll_wait(int epfd, struct epoll_event *events, int count, int timeout) { REAL(epoll_wait); COUNT(WAITS, 1); return real(epfd, events, count, timeout); }
+int epoll_ctl(int epfd, int op, int fd, struct epoll_event *event) { REAL(epoll_ctl); return real(epfd, op, fd, event); }
+int accept(int fd, struct sockaddr *address, socklen_t *length) { REAL(accept); return real(fd, address, length); }
+int accept4(int fd, struct sockaddr *address, socklen_t *length, int flags) { REAL(accept4); return real(fd, address, length, flags); }
+ssize_t read(int fd, void *buffer, size_t length) { REAL(read); COUNT(RECEIVES, 1); return real(fd, buffer, length); }
+ssize_t readv(int fd, const struct iovec *iov, int count) { REAL(readv); COUNT(RECEIVES, 1); return real(fd, iov, count); }
+ssize_t recv(int fd, void *buffer, size_t length, int flags) { REAL(recv); COUNT(RECEIVES, 1); return real(fd, buffer, length, flags); }
+ssize_t write(int fd, const void *buffer, size_t length) { REAL(write); COUNT(SENDS, 1); return sent(real(fd, buffer, length)); }
+ssize_t writev(int fd, const struct iovec *iov, int count) { REAL(writev); COUNT(SENDS, 1); return sent(real(fd, iov, count)); }
+ssize_t send(int fd, const void *buffer, size_t length, int flags) { REAL(send); COUNT(SENDS, 1); return sent(real(fd, buffer, length, flags)); }
+ssize_t sendmsg(int fd, const struct msghdr *message, int flags) { REAL(sendmsg); COUNT(SENDS, 1); return sent(real(fd, message, flags)); }
+
+long syscall(long number, ...)
+{
+	va_list ap;
+	long a[6];
+	va_start(ap, number);
+	for (int i = 0; i < 6; ++i)
+		a[i] = va_arg(ap, long);
+	va_end(ap);
+	REAL(syscall);
+	if (number == __NR_io_uring_enter)
+		COUNT(URING_ENTERS, 1);
+	return real(number, a[0], a[1], a[2], a[3], a[4], a[5]);
+}
+"""
+
+COUNTER_NAMES = ['mallocs', 'malloc_bytes', 'syscalls', 'waits', 'receives', 'sends', 'sent_bytes', 'uring_enters',
+                 'copied_bytes']
+
+def build_shim(directory):
+    """Sayaç kitaplığını geçici dizine derle"""
+    source = os.path.join(directory, 'benchcount.c')
+    library = os.path.join(directory, 'libbenchcount.so')
+    with open(source, 'w') as out:
+        out.write(SHIM_SOURCE)
+    subprocess.check_call([os.environ.get('CC', 'cc'), '-O2', '-shared', '-fPIC', '-o', library, source, '-ldl'])
+    return library
+
+def free_port():
+    """Boş bir TCP portu seç"""
+    probe = socket.socket()
+    probe.bind(('127.0.0.1', 0))
+    port = probe.getsockname()[1]
+    probe.close()
+    return port
+
+def raise_fd_limit():
+    """Açık dosya sınırını izin verilen en yükseğe çıkar (sunucu da devralır)"""
+    soft, hard = resource.getrlimit(resource.RLIMIT_NOFILE)
+    resource.setrlimit(resource.RLIMIT_NOFILE, (hard, hard))
+    return hard
+
+class Server:
+    """Sayaç kitaplığı yüklenmiş bir ircserv süreci"""
+
+    def __init__(self, binary, shim, settings):
+        self.port = free_port()
+        self.config = tempfile.NamedTemporaryFile('w', suffix='.conf', delete=False)
+        for key, value in settings.items():
+            self.config.write(f"{key} = {value}\n")
+        self.config.close()
+        self.counters = tempfile.NamedTemporaryFile(suffix='.cnt', delete=False)
+        self.counters.write(b"\0" * 8 * len(COUNTER_NAMES))
+        self.counters.close()
+        env = dict(os.environ, LD_PRELOAD=shim, BENCH_COUNTERS=self.counters.name)
+        self.process = subprocess.Popen([binary, str(self.port), PASSWORD, self.config.name],
+            stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL, env=env)
+        with open(self.counters.name, 'r+b') as counters:
+            self.map = mmap.mmap(counters.fileno(), 8 * len(COUNTER_NAMES))
+        deadline = time.time() + 5
+        while time.time() < deadline:
+            try:
+                socket.create_connection(('127.0.0.1', self.port)).close()
+                return
+            except OSError:
+                time.sleep(0.05)
+        raise RuntimeError(f"{binary} başlamadı")
+
+    def cpu_ns(self):
+        """Tüm iş parçacıklarının CPU süresi (ns), /proc/<pid>/task/*/schedstat"""
+        total = 0
+        task_dir = f"/proc/{self.process.pid}/task"
+        for task in os.listdir(task_dir):
+            try:
+                with open(f"{task_dir}/{task}/schedstat") as schedstat:
+                    total += int(schedstat.read().split()[0])
+            except OSError:
+                pass
+        return total
+
+    def rss_kb(self):
+        with open(f"/proc/{self.process.pid}/status") as status:
+            for line in status:
+                if line.startswith("VmRSS:"):
+                    return int(line.split()[1])
+        return 0
+
+    def sample(self):
+        """Sayaçların, CPU süresinin ve RSS'in anlık değeri"""
+        values = dict(zip(COUNTER_NAMES, struct.unpack_from(f"{len(COUNTER_NAMES)}Q", self.map)))
+        values['cpu_ns'] = self.cpu_ns()
+        values['rss_kb'] = self.rss_kb()
+        return values
+
+    def stop(self):
+        self.process.terminate()
+        self.process.wait()
+        self.map.close()
+        os.unlink(self.config.name)
+        os.unlink(self.counters.name)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.stop()
+
+def delta(before, after):
+    return dict((key, after[key] - before[key]) for key in before)
+
+class Client:
+    """Satır tabanlı basit IRC istemcisi"""
+
+    def __init__(self, port, nickname, register=True):
+        self.nickname = nickname
+        self.sock = socket.create_connection(('127.0.0.1', port))
+        self.pending = b""
+        if register:
+            self.send(f"PASS {PASSWORD}\r\nNICK {nickname}\r\nUSER {nickname} 0 * :{nickname}\r\n")
+
+    def send(self, text):
+        self.sock.sendall(text.encode())
+
+    def wait_for(self, *tokens, **options):
+        """Tüm token'ları içeren satır gelene kadar oku; okunan satırları döndür"""
+        tokens = [token.encode() for token in tokens]
+        lines = []
+        self.sock.settimeout(options.get('timeout', 30))
+        while True:
+            while b"\r\n" in self.pending:
+                line, self.pending = self.pending.split(b"\r\n", 1)
+                lines.append(line)
+                if all(token in line for token in tokens):
+                    return lines
+            chunk = self.sock.recv(1 << 16)
+            if not chunk:
+                raise RuntimeError(f"{self.nickname}: bağlantı kapandı")
+            self.pending += chunk
+
+    def close(self):
+        self.sock.close()
+
+def percentile(samples, fraction):
+    ordered = sorted(samples)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * fraction))]
+
+def ping_rounds(client, rounds):
+    """Ardışık PING/PONG gidiş-dönüş süreleri (µs)"""
+    rtts = []
+    for i in range(rounds):
+        start = time.perf_counter()
+        client.send(f"PING :r{i}\r\n")
+        client.wait_for(f"r{i}")
+        rtts.append((time.perf_counter() - start) * 1e6)
+    return rtts
+
+def open_idle(port, count):
+    """count adet kayıtlı ama sessiz bağlantı aç"""
+    sockets = []
+    for i in range(count):
+        sock = socket.create_connection(('127.0.0.1', port))
+        sock.sendall(f"PASS {PASSWORD}\r\nNICK idle{i}\r\nUSER idle 0 * :idle\r\n".encode())
+        sockets.append(sock)
+        if i % 500 == 499:
+            time.sleep(0.05)
+    return sockets
+
+def bench_idle(args, shim):
+    """Boşta bekleyen bağlantılar varken tek istemcinin PING maliyeti"""
+    limit = raise_fd_limit()
+    rounds = args.rounds or 2000
+    print(f"{'ikili':<16} {'arka uç':<9} {'bağlantı':>8} {'p50 µs':>8} {'p99 µs':>8} "
+          f"{'CPU µs/msj':>10} {'syscall/msj':>11} {'bekleme/msj':>11}")
+    for binary in args.binary:
+        for backend in (args.backends or 'poll,epoll,epoll-et').split(','):
+            for count in [int(n) for n in args.counts.split(',')]:
+                if count + 64 > limit:
+                    print(f"⚠️  {count} bağlantı için dosya sınırı yetersiz ({limit}), atlandı")
+                    continue
+                with Server(binary, shim, dict(args.settings, io_backend=backend)) as server:
+                    idle = open_idle(server.port, count)
+                    active = Client(server.port, 'active')
+                    active.wait_for(" 001 ")
+                    ping_rounds(active, 50)
+                    before = server.sample()
+                    rtts = ping_rounds(active, rounds)
+                    used = delta(before, server.sample())
+                    print(f"{os.path.basename(binary):<16} {backend:<9} {count:>8} "
+                          f"{percentile(rtts, 0.5):>8.0f} {percentile(rtts, 0.99):>8.0f} "
+                          f"{used['cpu_ns'] / 1e3 / rounds:>10.1f} "
+                          f"{used['syscalls'] / rounds:>11.2f} {used['waits'] / rounds:>11.2f}")
+                    active.close()
+                    for sock in idle:
+                        sock.close()
+
+def join_all(client, channels):
+    """Kanallara katıl ve sonuncusunun NAMES sonu gelene kadar bekle"""
+    client.send("".join(f"JOIN #q{i}\r\n" for i in range(channels)))
+    client.wait_for(" 366 ", f"#q{channels - 1}")
+
+def bench_quit(args, shim):
+    """Birçok ortak kanalı olan kullanıcının NICK ve QUIT fan-out maliyeti"""
+    print(f"{'ikili':<16} {'NICK satır/eş':>13} {'QUIT satır/eş':>13} {'KB/tur':>8} "
+          f"{'malloc/tur':>10} {'CPU µs/tur':>10}")
+    rounds = args.rounds or 20
+    for binary in args.binary:
+        with Server(binary, shim, args.settings) as server:
+            peers = [Client(server.port, f"peer{i}") for i in range(args.peers)]
+            for peer in peers:
+                peer.wait_for(" 001 ")
+                join_all(peer, args.channels)
+            # İşaretçi yalnızca #q0'dadır; QUIT'i gördükten sonra yolladığı
+            # satır her eşe tüm fan-out satırlarından sonra ulaşır
+            marker = Client(server.port, "marker")
+            marker.wait_for(" 001 ")
+            join_all(marker, 1)
+
+            nick_lines = quit_lines = 0
+            total = None
+            for r in range(rounds):
+                leaver = Client(server.port, f"leaver{r}")
+                leaver.wait_for(" 001 ")
+                join_all(leaver, args.channels)
+                for peer in peers:
+                    peer.wait_for(f":leaver{r}!", f"#q{args.channels - 1}")
+                marker.wait_for(f":leaver{r}!")
+
+                before = server.sample()
+                leaver.send(f"NICK moved{r}\r\nQUIT :bye\r\n")
+                marker.wait_for(f":moved{r}!", "QUIT")
+                marker.send(f"PRIVMSG #q0 :end{r}\r\n")
+                for peer in peers:
+                    lines = peer.wait_for(f"end{r}")
+                    nick_lines += sum(1 for line in lines if b" NICK " in line)
+                    quit_lines += sum(1 for line in lines if b" QUIT " in line)
+                used = delta(before, server.sample())
+                total = used if total is None else dict((k, total[k] + used[k]) for k in total)
+                leaver.close()
+
+            print(f"{os.path.basename(binary):<16} {nick_lines / rounds / args.peers:>13.1f} "
+                  f"{quit_lines / rounds / args.peers:>13.1f} {total['sent_bytes'] / 1024 / rounds:>8.1f} "
+                  f"{total['mallocs'] / rounds:>10.0f} {total['cpu_ns'] / 1e3 / rounds:>10.0f}")
+            for client in peers + [marker]:
+                client.close()
+
+def drain_lines(sockets, expected, timeout=60):
+    """Her sokette expected satır birikene kadar oku"""
+    selector = selectors.DefaultSelector()
+    counts = {}
+    for sock in sockets:
+        sock.setblocking(False)
+        selector.register(sock, selectors.EVENT_READ)
+        counts[sock] = 0
+    waiting = len(sockets)
+    deadline = time.time() + timeout
+    while waiting > 0 and time.time() < deadline:
+        for key, _ in selector.select(1):
+            data = key.fileobj.recv(1 << 16)
+            before = counts[key.fileobj]
+            counts[key.fileobj] += data.count(b"\n")
+            if before < expected <= counts[key.fileobj]:
+                waiting -= 1
+    selector.close()
+    for sock in sockets:
+        sock.setblocking(True)
+    if waiting > 0:
+        raise RuntimeError(f"{waiting} soket beklenen satırları almadı")
+
+SLOW_PAIRS = 10000
+
+def bench_fanout(args, shim):
+    """Büyük bir kanala yayın ve yayınlar arasında küçük yanıtlar alan yavaş okuyucu"""
+    raise_fd_limit()
+    messages = args.rounds or 100
+    text = "x" * 400
+    print(f"{'ikili':<16} {'malloc/msj':>10} {'ayrılan KB/msj':>14} {'kopya KB/msj':>12} "
+          f"{'send/msj':>9} {'CPU µs/msj':>10} {'yavaş okuyucu RSS KB':>20}")
+    for binary in args.binary:
+        with Server(binary, shim, args.settings) as server:
+            members = [Client(server.port, f"fan{i}") for i in range(args.members)]
+            for member in members:
+                member.wait_for(" 001 ")
+                member.send("JOIN #fan\r\n")
+                member.wait_for(" 366 ")
+            sender = Client(server.port, "sender")
+            sender.wait_for(" 001 ")
+            sender.send("JOIN #fan\r\n")
+            sender.wait_for(" 366 ")
+            for member in members:
+                member.wait_for(":sender!", "JOIN")
+
+            # Eski derlemeler ardışık gönderilen satırları yeni veri gelene
+            # kadar işlemeyebilir; her mesaj bir üyede görülünce sıradaki yollanır
+            probe = members[0]
+            before = server.sample()
+            for i in range(messages):
+                sender.send(f"PRIVMSG #fan :{i} {text}\r\n")
+                probe.wait_for(f"#fan :{i} ")
+            drain_lines([member.sock for member in members[1:]], messages)
+            used = delta(before, server.sample())
+            for client in members + [sender]:
+                client.close()
+
+        # Okumayan istemciye yayınlar ve özel mesajlar sırayla gelir. Çekirdek
+        # gönderim tamponunu aşacak kadar veri yollanır; SendQ sınırları
+        # yükseltilir ki kuyruk atılmadan RSS ölçülebilsin. Yığın önceki
+        # aşamadan şişmesin diye ayrı bir sunucuda ölçülür.
+        settings = dict(args.settings, user_sendq_soft=1 << 26, user_sendq_hard=1 << 26)
+        with Server(binary, shim, settings) as server:
+            sender = Client(server.port, "sender")
+            sender.wait_for(" 001 ")
+            sender.send("JOIN #fan\r\n")
+            sender.wait_for(" 366 ")
+            slow = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+            slow.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 4096)
+            slow.connect(('127.0.0.1', server.port))
+            slow.sendall(f"PASS {PASSWORD}\r\nNICK slow\r\nUSER slow 0 * :slow\r\nJOIN #fan\r\n".encode())
+            sender.wait_for(":slow!", "JOIN")
+            rss_before = server.rss_kb()
+            try:
+                for i in range(SLOW_PAIRS):
+                    sender.send(f"PRIVMSG #fan :{i} {text}\r\nPRIVMSG slow :{i}\r\nPING :p{i}\r\n")
+                    sender.wait_for(f"p{i}", timeout=5)
+                rss_growth = server.rss_kb() - rss_before
+            except socket.timeout:
+                rss_growth = "takıldı"
+            slow.close()
+            sender.close()
+
+            print(f"{os.path.basename(binary):<16} {used['mallocs'] / messages:>10.0f} "
+                  f"{used['malloc_bytes'] / 1024 / messages:>14.1f} {used['copied_bytes'] / 1024 / messages:>12.1f} "
+                  f"{used['sends'] / messages:>9.0f} {used['cpu_ns'] / 1e3 / messages:>10.0f} {rss_growth:>20}")
+
+def bench_parser(args, shim):
+    """15 parametreli satırların ayrıştırma hızı (mesaj/sn)"""
+    count = args.rounds or 200000
+    # Tek üyeli kanala PRIVMSG: satır tamamen ayrıştırılır ama yanıt üretmez.
+    # Eski ayrıştırıcı öneki tanımadığı için satırda önek yoktur.
+    params = " ".join(f"p{i}" for i in range(2, 15))
+    line = f"PRIVMSG #parse {params} :{'trailing text ' * 8}\r\n"
+    batch = (line * 1000).encode()
+    print(f"{'ikili':<16} {'mesaj/sn':>10} {'CPU ns/msj':>10} {'malloc/msj':>10} {'yanıt':>6}")
+    for binary in args.binary:
+        with Server(binary, shim, args.settings) as server:
+            client = Client(server.port, "bench")
+            client.wait_for(" 001 ")
+            client.send("JOIN #parse\r\n")
+            client.wait_for(" 366 ")
+
+            before = server.sample()
+            for _ in range(count // 1000):
+                client.sock.sendall(batch)
+            client.send("PING done\r\n")
+            replies = len(client.wait_for("done", timeout=300)) - 1
+            used = delta(before, server.sample())
+            client.close()
+
+            sent = count // 1000 * 1000
+            print(f"{os.path.basename(binary):<16} {sent / (used['cpu_ns'] / 1e9):>10.0f} "
+                  f"{used['cpu_ns'] / sent:>10.0f} {used['mallocs'] / sent:>10.1f} {replies:>6}")
+
+# Her biri tam olarak bir yanıt üretir: PONG, 401, 403, 403, 421, 324
+REPLY_COMMANDS = ["PING t{0}", "PRIVMSG nobody{0} :hi", "MODE #none{0}", "TOPIC #none{0}", "BENCH{0}", "MODE #reply"]
+
+def bench_reply(args, shim):
+    """Tek satırlık yanıt üreten komutlar: yanıt başına malloc ve CPU"""
+    count = args.rounds or 100000
+    batch_size = 1000
+    print(f"{'ikili':<16} {'yanıt/sn':>10} {'CPU ns/yanıt':>12} {'malloc/yanıt':>12} {'KB/yanıt':>9}")
+    for binary in args.binary:
+        with Server(binary, shim, args.settings) as server:
+            client = Client(server.port, "bench")
+            client.wait_for(" 001 ")
+            client.send("JOIN #reply\r\n")
+            client.wait_for(" 366 ")
+            client.send("PING ready\r\n")
+            client.wait_for("ready")
+
+            replies = 0
+            before = server.sample()
+            for b in range(count // batch_size):
+                lines = [REPLY_COMMANDS[i % len(REPLY_COMMANDS)].format(i) for i in range(batch_size)]
+                client.send("\r\n".join(lines) + f"\r\nPING b{b}\r\n")
+                replies += len(client.wait_for(f"b{b}")) - 1
+            used = delta(before, server.sample())
+            client.close()
+
+            print(f"{os.path.basename(binary):<16} {replies / (used['cpu_ns'] / 1e9):>10.0f} "
+                  f"{used['cpu_ns'] / replies:>12.0f} {used['mallocs'] / replies:>12.2f} "
+                  f"{used['malloc_bytes'] / 1024 / replies:>9.2f}")
+
+GROUP_SIZE = 8
+WORKER_BATCH = 20
+
+def bench_workers(args, shim):
+    """Worker sayısına göre ölçekleme: çiftler arası PRIVMSG ve küçük kanallara yayın"""
+    raise_fd_limit()
+    rounds = args.rounds or 20
+    clients = args.clients - args.clients % GROUP_SIZE
+    # Her istemci eşine ve kendi kanalına WORKER_BATCH mesaj yollar; bağlantılar
+    # worker'lara dağıldığı için teslimatların çoğu worker'lar arasıdır
+    per_round = WORKER_BATCH * GROUP_SIZE
+    print(f"{'ikili':<16} {'worker':>6} {'satır/sn':>10} {'CPU µs/satır':>12} {'CPU/duvar':>9}")
+    for binary in args.binary:
+        for workers in [int(n) for n in args.workers.split(',')]:
+            with Server(binary, shim, dict(args.settings, workers=workers)) as server:
+                members = [Client(server.port, f"w{i}") for i in range(clients)]
+                for member in members:
+                    member.wait_for(" 001 ")
+                for start in range(0, clients, GROUP_SIZE):
+                    group = members[start:start + GROUP_SIZE]
+                    for member in group:
+                        member.send(f"JOIN #g{start}\r\n")
+                        member.wait_for(" 366 ")
+                    for member in group[:-1]:
+                        member.wait_for(f":{group[-1].nickname}!", "JOIN")
+
+                before = server.sample()
+                started = time.perf_counter()
+                for r in range(rounds):
+                    for i, member in enumerate(members):
+                        partner = members[i ^ 1].nickname
+                        channel = f"#g{i - i % GROUP_SIZE}"
+                        member.send("".join(f"PRIVMSG {partner} :{r} {j}\r\nPRIVMSG {channel} :{r} {j}\r\n"
+                                            for j in range(WORKER_BATCH)))
+                    drain_lines([member.sock for member in members], per_round)
+                elapsed = time.perf_counter() - started
+                used = delta(before, server.sample())
+                for member in members:
+                    member.close()
+
+                lines = rounds * clients * per_round
+                print(f"{os.path.basename(binary):<16} {workers:>6} {lines / elapsed:>10.0f} "
+                      f"{used['cpu_ns'] / 1e3 / lines:>12.2f} {used['cpu_ns'] / 1e9 / elapsed:>9.2f}")
+
+def receive_latencies(sockets, expected, timeout=60):
+    """Her sokette expected satır gelene kadar oku; satır sonundaki gönderim
+    zamanından teslim gecikmelerini (µs) döndür"""
+    selector = selectors.DefaultSelector()
+    pending = {}
+    counts = {}
+    for sock in sockets:
+        sock.setblocking(False)
+        selector.register(sock, selectors.EVENT_READ)
+        pending[sock] = b""
+        counts[sock] = 0
+    latencies = []
+    waiting = len(sockets)
+    deadline = time.time() + timeout
+    while waiting > 0 and time.time() < deadline:
+        for key, _ in selector.select(1):
+            sock = key.fileobj
+            data = pending[sock] + sock.recv(1 << 16)
+            now = time.perf_counter_ns()
+            lines = data.split(b"\r\n")
+            pending[sock] = lines.pop()
+            for line in lines:
+                latencies.append((now - int(line.rsplit(b" ", 1)[1])) / 1e3)
+            before = counts[sock]
+            counts[sock] += len(lines)
+            if before < expected <= counts[sock]:
+                waiting -= 1
+    selector.close()
+    for sock in sockets:
+        sock.setblocking(True)
+    if waiting > 0:
+        raise RuntimeError(f"{waiting} soket beklenen satırları almadı")
+    return latencies
+
+def bench_uring(args, shim):
+    """Aynı yük altında io_backend karşılaştırması: mesaj başına sistem çağrısı ve gecikme"""
+    raise_fd_limit()
+    rounds = args.rounds or 200
+    clients = args.clients - args.clients % 2
+    # Her turda tüm istemciler eşine birer mesaj yollar, böylece sunucu bir
+    # uyanışta birçok hazır bağlantı görür
+    print(f"{'ikili':<16} {'arka uç':<9} {'p50 µs':>8} {'p99 µs':>8} {'CPU µs/msj':>10} {'syscall/msj':>11} "
+          f"{'enter/msj':>9} {'recv/msj':>8} {'send/msj':>8} {'bekleme/msj':>11}")
+    for binary in args.binary:
+        for backend in (args.backends or 'poll,epoll,io_uring').split(','):
+            with Server(binary, shim, dict(args.settings, io_backend=backend)) as server:
+                members = [Client(server.port, f"u{i}") for i in range(clients)]
+                for member in members:
+                    member.wait_for(" 001 ")
+
+                latencies = []
+                before = server.sample()
+                for r in range(rounds):
+                    for i, member in enumerate(members):
+                        member.send(f"PRIVMSG {members[i ^ 1].nickname} :{r} {time.perf_counter_ns()}\r\n")
+                    latencies += receive_latencies([member.sock for member in members], 1)
+                used = delta(before, server.sample())
+                for member in members:
+                    member.close()
+
+                messages = rounds * clients
+                if backend == 'io_uring' and used['uring_enters'] == 0:
+                    print(f"⚠️  {os.path.basename(binary)}: io_uring kullanılamadı, sunucu başka arka uca düştü")
+                print(f"{os.path.basename(binary):<16} {backend:<9} {percentile(latencies, 0.5):>8.0f} "
+                      f"{percentile(latencies, 0.99):>8.0f} {used['cpu_ns'] / 1e3 / messages:>10.1f} "
+                      f"{used['syscalls'] / messages:>11.2f} {used['uring_enters'] / messages:>9.2f} "
+                      f"{used['receives'] / messages:>8.2f} {used['sends'] / messages:>8.2f} "
+                      f"{used['waits'] / messages:>11.2f}")
+
+MODES = {
+    'fanout': bench_fanout,
+    'idle': bench_idle,
+    'parser': bench_parser,
+    'quit': bench_quit,
+    'reply': bench_reply,
+    'uring': bench_uring,
+    'workers': bench_workers,
+}
+
+def parse_settings(pairs):
+    settings = {'flood_burst': 0, 'log_level': 'warn'}
+    for pair in pairs:
+        key, value = pair.split('=', 1)
+        settings[key.strip()] = value.strip()
+    return settings
+
+def main():
+    parser = argparse.ArgumentParser(description="ircserv benchmark")
+    parser.add_argument('mode', choices=sorted(MODES))
+    parser.add_argument('-b', '--binary', action='append', help="ölçülecek ircserv (tekrarlanabilir)")
+    parser.add_argument('-s', '--set', action='append', default=[], metavar='KEY=VALUE',
+                        help="ek config ayarı (tekrarlanabilir)")
+    parser.add_argument('--rounds', type=int, help="tur sayısı (idle 2000, quit 20, fanout 100 mesaj, parser 200000 satır, reply 100000 komut, workers 20, uring 200)")
+    parser.add_argument('--counts', default='1000,10000,50000', help="idle: boşta bağlantı sayıları")
+    parser.add_argument('--backends', help="idle/uring: io_backend değerleri (idle poll,epoll,epoll-et; uring poll,epoll,io_uring)")
+    parser.add_argument('--channels', type=int, default=20, help="quit: ortak kanal sayısı")
+    parser.add_argument('--peers', type=int, default=50, help="quit: tüm kanallardaki eş sayısı")
+    parser.add_argument('--members', type=int, default=1000, help="fanout: kanal üye sayısı")
+    parser.add_argument('--workers', default='1,2,4,8', help="workers: worker sayıları")
+    parser.add_argument('--clients', type=int, default=200, help="workers/uring: istemci sayısı")
+    args = parser.parse_args()
+    args.binary = args.binary or ['./ircserv']
+    args.settings = parse_settings(args.set)
+
+    print(f"🚀 {args.mode} benchmark başlatılıyor...")
+    with tempfile.TemporaryDirectory() as directory:
+        MODES[args.mode](args, build_shim(directory))
+    print("✅ Benchmark tamamlandı")
+
+if __name__ == "__main__":
+    main()
@@ -20,12 +20,18 @@
 #include <iostream>
 #include <sys/socket.h>
 #include "Client.hpp"
+#include "Pool.hpp"
 #include "IRCResponse.hpp"
 
 class Server;
 
 class Channel
 {
+	public:
+		// Member and invite trees take their nodes from the server's pool
+		typedef std::map<int, Client *, std::less<int>, PoolAllocator<std::pair<const int, Client *> > > Members;
+		typedef std::set<int, std::less<int>, PoolAllocator<int> > Invites;
+
 	private:
 		std::string _name;
 		std::string _topic;
@@ -33,12 +39,12 @@ class Channel
 		size_t _userLimit;
 		bool _inviteOnly;
 		bool _topicRestricted;
-		std::map<int, Client *> _users;
-		std::map<int, Client *> _operators;
-		std::set<int> _invited;
+		Members _users;
+		Members _operators;
+		Invites _invited;
 
 	public:
-		Channel(const std::string &name);
+		Channel(const std::string &name, Pool &memberships);
 		~Channel();
 
 		// Getters
@@ -49,6 +55,7 @@ class Channel
 		bool addUser(Client *user);
 		void removeUser(int fd);
 		bool isUserInChannel(int fd) const;
+		const Members &getUsers() const;
 
 		// Operator management
 		void addOperator(Client *user);
@@ -76,7 +83,7 @@ class Channel
 		size_t getUserCount() const;
 
 		// Broadcast
-		void broadcast(const std::string &message, class Server *server, int exceptFd = -1);
+		void broadcast(const ReplyBuffer &reply, class Server *server, int exceptFd = -1, bool essential = true);
 		void sendUserList(class Server *server, class Client *client);
 
 		// Static utility functions
@@ -34,9 +34,6 @@ public:
 	static void handleINVITE(Server *server, Client *client, const IRCMessage &msg);
 	static void handleTOPIC(Server *server, Client *client, const IRCMessage &msg);
 
-	// Helper function
-	static bool validateBasicCommand(Server *server, Client *client, const IRCMessage &msg, const std::string &commandName);
-
 private:
 	ChannelCommands();
 	ChannelCommands(const ChannelCommands &other);
@@ -18,53 +18,111 @@
 #include <fcntl.h>
 #include <cctype>
 #include <map>
+#include <set>
+#include <deque>
+#include "Connection.hpp"
+#include "ReplyBuffer.hpp"
+#include "Logger.hpp"
+#include "TimerWheel.hpp"
+#include "ConnectionClass.hpp"
+#include "Pool.hpp"
 
 class Server;
+class Channel;
 
-class Client
+class Client : public Connection
 {
+	public:
+		typedef std::set<Channel *, std::less<Channel *>, PoolAllocator<Channel *> > ChannelSet;
+
 	private:
-		int			_client_fd;
 		std::string	_nickname;
 		std::string	_username;
 		std::string	_realname;
-		std::string	_readBuffer;
-		std::string	_sendBuffer;
+		std::string	_hostname;
+		std::string	_prefix;
+		ChannelSet	_channels;
 		bool		_isRegistered;
 		bool		_hasPassword;
 		bool		_hasNick;
 		bool		_hasUser;
+		unsigned long	_fanoutMark;
+		unsigned int	_fanoutsPending;
+		TimerWheel::Timer	_timer;
+		unsigned long	_lastActivity;
+		bool		_awaitingPong;
+		const ConnectionClass	*_class;
+		int			_worker;
+		TimerWheel::Timer	_floodTimer;
+		unsigned long	_floodClock;
+		std::deque<std::string>	_deferredLines;
+		size_t		_deferredBytes;
+		unsigned long	_floodPenalties;
 
 	public:
 		// Constructor & Destructor
-		Client(int client_fd);
+		Client(int fd, int id, Pool &memberships);
 		~Client();
 
 		// Getters
+		// Key used by channels and the nick index: the socket fd with a
+		// single worker, a process-wide connection id with several
 		int getClientFd() const;
 		const std::string& getNickname() const;
 		const std::string& getUsername() const;
 		const std::string& getRealname() const;
-		std::string& getReadBuffer();
-		std::string& getSendBuffer();
+		const std::string& getHostname() const;
+		const std::string& getPrefix() const;
 		bool isRegistered() const;
 		bool hasPassword() const;
 		bool hasNick() const;
 		bool hasUser() const;
+		const ChannelSet& getChannels() const;
+		TimerWheel::Timer& getTimer();
+		unsigned long getLastActivity() const;
+		bool isAwaitingPong() const;
+		const ConnectionClass* getConnectionClass() const;
+		int getWorker() const;
 
 		// Setters
 		void setNickname(const std::string& nickname);
 		void setUsername(const std::string& username);
 		void setRealname(const std::string& realname);
+		void setHostname(const std::string& hostname);
 		void setPassword(bool has);
 		void setRegistered(bool registered);
+		void setAwaitingPong(bool awaiting);
+		void touch(unsigned long nowMs);
+		void setConnectionClass(const ConnectionClass* connectionClass);
+		void setWorker(int worker);
+
+		// Channel membership
+		void joinedChannel(Channel* channel);
+		void leftChannel(Channel* channel);
+		bool markForFanout(unsigned long epoch);
+		// NICK/QUIT fan-outs still waiting on the channel shards
+		void beginFanout();
+		unsigned int endFanout();
+		bool isFanoutPending() const;
+
+		// Flood control: every command pushes the client's clock ahead by
+		// its cost; lines that arrive while it is too far ahead wait here.
+		TimerWheel::Timer& getFloodTimer();
+		unsigned long getFloodLag(unsigned long nowMs) const;
+		bool hasDeferredLines() const;
+		size_t getDeferredBytes() const;
+		unsigned long getFloodPenalties() const;
+		void chargeFlood(unsigned long nowMs, unsigned long costMs);
+		void deferLine(const char* line, size_t length);
+		void addFloodPenalty();
+		std::string popDeferredLine();
 
 		// Buffer operations
-		void appendToReadBuffer(const std::string& data);
 		void appendToSendBuffer(const std::string& data);
 		void clearReadBuffer();
 		void clearSendBuffer();
-		void writeAndEnablePollOut(class Server* server, const std::string& message);
+		void writeAndEnablePollOut(class Server* server, const ReplyBuffer& reply, bool essential = true);
+		void writeAndEnablePollOut(class Server* server, SharedPayload* payload, bool essential = true);
 
 
 		// Static utility functions
@@ -75,6 +133,8 @@ class Client
 		Client(Client const &other);
 		Client &operator=(Client const &other);
 		void updateRegistrationStatus();
+		void updatePrefix();
+		bool admitToSendQueue(class Server* server, size_t length, bool essential);
 };
 
 #endif
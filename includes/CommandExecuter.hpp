@@ -17,6 +17,7 @@
 #include "IRCResponse.hpp"
 #include "ChannelCommands.hpp"
 #include <string>
+#include <sstream>
 #include <vector>
 #include <algorithm>
 #include <sys/socket.h>
@@ -27,12 +28,27 @@
 class Server;
 class Client;
 class Channel;
+class Pool;
 
 class CommandExecuter
 {
 public:
+	typedef void (*Handler)(Server *server, Client *client, const IRCMessage &msg);
+
+	struct CommandEntry
+	{
+		const char *name;
+		Handler handler;
+		bool allowedUnregistered;
+		size_t minParams;
+		unsigned long cost;
+		unsigned long calls;
+	};
+
 	// Main command dispatcher
 	static void executeCommand(Server *server, Client *client, const IRCMessage &msg);
+	static Handler admitCommand(Server *server, Client *client, const IRCMessage &msg);
+	static const CommandEntry &getCommandEntry(CommandId id);
 
 	// Authentication and registration commands
 	static void handlePASS(Server *server, Client *client, const IRCMessage &msg);
@@ -44,13 +60,16 @@ public:
 
 	// Server utility commands
 	static void handlePING(Server *server, Client *client, const IRCMessage &msg);
+	static void handlePONG(Server *server, Client *client, const IRCMessage &msg);
 	static void handleQUIT(Server *server, Client *client, const IRCMessage &msg);
 	static void handleDisconnection(Server *server, Client *client, const std::string message);
-
-	// Helper functions
-	static bool validateBasicCommand(Server *server, Client *client, const IRCMessage &msg, const std::string &commandName);
+	static void handleSTATS(Server *server, Client *client, const IRCMessage &msg);
 
 private:
+	static CommandEntry commandTable[CMD_COUNT];
+
+	static void sendPoolStats(Server *server, Client *client, const Pool &(Server::*getPool)() const);
+
 	CommandExecuter();
 	CommandExecuter(const CommandExecuter &other);
 	CommandExecuter &operator=(const CommandExecuter &other);
@@ -19,20 +19,23 @@
 #include <algorithm>
 #include <iostream>
 #include "IRCMessage.hpp"
+#include "Logger.hpp"
 
 
 class CommandParser
 {
 	public:
-		// Main parsing function
-		static IRCMessage parseMessage(const std::string& message);
+		// Main parsing functions
+		static bool parse(const char* line, size_t length, RawMessage& out);
+		static IRCMessage parseMessage(const char* line, size_t length);
 
 		// Utility functions
-		static std::vector<std::string> splitString(const std::string& str, char delimiter);
-		static std::string trim(const std::string& str);
-		static bool isValidCommand(const std::string& command);
+		static bool isValidCommand(const StringView& command);
+		static CommandId resolveCommand(const StringView& command);
 
 	private:
+		static bool matches(const StringView& command, const char* name);
+
 		CommandParser();
 		CommandParser(const CommandParser& other);
 		CommandParser& operator=(const CommandParser& other);
@@ -0,0 +1,67 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Config.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/20 14:02:11 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/20 14:02:11 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONFIG_HPP
+#define CONFIG_HPP
+
+#include <string>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <exception>
+#include <cctype>
+
+class Config
+{
+	private:
+		std::map<std::string, std::string> _values;
+
+		void parseLine(const std::string &line, size_t lineNumber);
+		static std::string trim(const std::string &str);
+
+	public:
+		Config();
+		Config(const Config &other);
+		Config &operator=(const Config &other);
+		~Config();
+
+		// Loading
+		void loadFile(const std::string &path);
+		void set(const std::string &key, const std::string &value);
+
+		// Lookup
+		bool has(const std::string &key) const;
+		std::string getString(const std::string &key, const std::string &fallback) const;
+		long getNumber(const std::string &key, long fallback) const;
+
+		// Exceptions
+		class ConfigFileUnreadable : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+
+		class InvalidConfigLine : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+
+		class InvalidConfigValue : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+};
+
+#endif
@@ -0,0 +1,90 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Connection.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/29 14:37:21 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/29 14:37:21 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONNECTION_HPP
+#define CONNECTION_HPP
+
+#include <string>
+#include "SendQueue.hpp"
+#include "LineBuffer.hpp"
+#include "Throttle.hpp"
+
+// The socket side of a client: what a worker needs to read, frame and
+// write, without any IRC state. With a single worker the Client that
+// inherits this is the connection itself; with several, the worker keeps
+// a bare Connection and the hub keeps the Client.
+class Connection
+{
+	public:
+		// Bytes handed to a worker but not yet written to the socket. Shared
+		// by the hub and the worker; whoever lets go last frees it.
+		class Backlog
+		{
+			private:
+				volatile long _bytes;
+				volatile int _refs;
+
+				Backlog();
+				Backlog(const Backlog &other);
+				Backlog &operator=(const Backlog &other);
+
+			public:
+				static Backlog *create();
+
+				void retain();
+				void release();
+				void add(long bytes);
+				size_t get();
+		};
+
+	protected:
+		int			_fd;
+		int			_id;
+		LineBuffer	_readBuffer;
+		SendQueue	_sendQueue;
+		Backlog		*_backlog;
+		Throttle::Address	_address;
+		bool		_readReady;
+		bool		_dirty;
+		bool		_closing;
+		std::string	_closeReason;
+
+	public:
+		Connection(int fd, int id);
+		virtual ~Connection();
+
+		// Getters
+		int getFd() const;
+		int getId() const;
+		LineBuffer& getReadBuffer();
+		SendQueue& getSendQueue();
+		Backlog* getBacklog() const;
+		const Throttle::Address& getAddress() const;
+		size_t pendingBytes() const;
+		bool isReadReady() const;
+		bool isDirty() const;
+		bool isClosing() const;
+		const std::string& getCloseReason() const;
+
+		// Setters
+		void setBacklog(Backlog* backlog);
+		void setAddress(const Throttle::Address& address);
+		void setReadReady(bool ready);
+		void setDirty(bool dirty);
+		void markClosing(const std::string& reason);
+
+	private:
+		Connection(const Connection &other);
+		Connection &operator=(const Connection &other);
+};
+
+#endif
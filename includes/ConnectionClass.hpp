@@ -0,0 +1,47 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConnectionClass.hpp                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/28 10:12:44 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/28 10:12:44 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef CONNECTIONCLASS_HPP
+#define CONNECTIONCLASS_HPP
+
+#include <string>
+#include <exception>
+#include "Config.hpp"
+
+// Limits shared by every connection in a class. Each setting is read
+// from the config as "<class>_<setting>", e.g. user_sendq_hard.
+class ConnectionClass
+{
+	private:
+		std::string _name;
+		size_t _sendqSoft;
+		size_t _sendqHard;
+
+	public:
+		ConnectionClass(const std::string &name, size_t sendqSoft, size_t sendqHard);
+
+		void load(const Config &config);
+
+		// Getters
+		const std::string &getName() const;
+		size_t getSendqSoft() const;
+		size_t getSendqHard() const;
+
+		// Exceptions
+		class InvalidLimits : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+};
+
+#endif
@@ -15,30 +15,76 @@
 
 #include <string>
 #include <vector>
+#include <cstddef>
+
+enum CommandId
+{
+	CMD_UNKNOWN = 0,
+	CMD_PASS,
+	CMD_NICK,
+	CMD_USER,
+	CMD_PING,
+	CMD_PONG,
+	CMD_QUIT,
+	CMD_JOIN,
+	CMD_PART,
+	CMD_KICK,
+	CMD_INVITE,
+	CMD_TOPIC,
+	CMD_MODE,
+	CMD_PRIVMSG,
+	CMD_STATS,
+	CMD_COUNT
+};
+
+struct StringView
+{
+	const char *data;
+	size_t length;
+};
+
+// Parsed form of one line. Every field points into the caller's buffer.
+struct RawMessage
+{
+	static const size_t MAX_MIDDLE_PARAMS = 14;
+
+	StringView tags;
+	StringView prefix;
+	StringView command;
+	CommandId commandId;
+	StringView params[MAX_MIDDLE_PARAMS];
+	size_t paramCount;
+	StringView trailing;
+	bool hasTrailing;
+};
 
 class IRCMessage
 {
 	private:
-		std::string command;
-		std::vector<std::string> params;
-		std::string trailing;
+		RawMessage raw;
+
+		static std::string toString(const StringView &view);
 	public:
 		IRCMessage();
+		IRCMessage(const RawMessage &raw);
 		IRCMessage(const IRCMessage &other);
 		IRCMessage &operator=(const IRCMessage &other);
 		~IRCMessage();
 
 		// Getters
-		const std::string &getPrefix() const;
-		const std::string &getCommand() const;
-		const std::string &getTrailing() const;
-		const std::vector<std::string> &getParams() const;
-
-		// Setter
-		void setPrefix(const std::string &prefix);
-		void setCommand(const std::string &command);
-		void setTrailing(const std::string &trailing);
-		void addParam(const std::string &param);
+		const RawMessage &getRaw() const;
+		std::string getPrefix() const;
+		std::string getCommand() const;
+		CommandId getCommandId() const;
+		std::string getTrailing() const;
+		bool hasTrailing() const;
+		bool isTrailingEmpty() const;
+		size_t paramCount() const;
+		std::string getParam(size_t index) const;
+		std::vector<std::string> getParams() const;
+
+		// Static utility functions
+		static void reset(RawMessage &raw);
 };
 
 #endif
@@ -0,0 +1,73 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LineBuffer.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/24 09:31:02 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/24 09:31:02 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LINEBUFFER_HPP
+#define LINEBUFFER_HPP
+
+#include <string>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <cerrno>
+
+class LineBuffer
+{
+	public:
+		static const size_t INITIAL_CAPACITY = 4096;
+		static const size_t MAX_LINE = 512;
+		static const size_t MAX_TAGGED_LINE = 8191;
+
+		enum Frame
+		{
+			NONE,
+			LINE,
+			TOO_LONG
+		};
+
+	private:
+		char *_data;
+		size_t _capacity;
+		size_t _head;
+		size_t _tail;
+		size_t _scanned;
+		size_t _maxLine;
+		size_t _limit;
+		bool _discarding;
+		std::string _scratch;
+
+		void grow();
+
+		LineBuffer(const LineBuffer &other);
+		LineBuffer &operator=(const LineBuffer &other);
+
+	public:
+		LineBuffer();
+		~LineBuffer();
+
+		// Input
+		ssize_t readFrom(int fd, size_t limit);
+		size_t append(const char *data, size_t length);
+		void clear();
+		void setMaxLine(size_t maxLine, size_t chunk = 0);
+
+		// Framing: yields the next complete line without its terminator.
+		// The view stays valid until the next readFrom() call. A line that
+		// outgrows the limit is reported once as TOO_LONG and its bytes are
+		// dropped as they arrive, up to its terminator.
+		Frame nextLine(const char *&line, size_t &length);
+
+		// Getters
+		size_t size() const;
+		bool empty() const;
+};
+
+#endif
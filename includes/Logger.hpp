@@ -0,0 +1,128 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Logger.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/26 11:20:37 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/26 11:20:37 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <string>
+#include <cstring>
+#include <exception>
+#include <unistd.h>
+
+class Config;
+
+// Checks the level before any formatting happens, so a suppressed record
+// costs one comparison:  LOG(NET, INFO) << "Client " << fd << " connected";
+#define LOG(category, level) \
+	for (bool logPending = Logger::enabled(Logger::category, Logger::level); \
+		logPending; logPending = false) \
+		Logger::Record(Logger::category, Logger::level)
+
+class Logger
+{
+	public:
+		enum Level
+		{
+			DEBUG,
+			INFO,
+			WARN,
+			ERROR,
+			OFF
+		};
+
+		enum Category
+		{
+			NET,
+			COMMAND,
+			CHANNEL,
+			CATEGORY_COUNT
+		};
+
+		static const size_t LINE_SIZE = 256;
+		static const size_t RING_SIZE = 4096;
+
+		// One log line, formatted on the caller's stack and pushed to the
+		// ring when it goes out of scope.
+		class Record
+		{
+			private:
+				Category _category;
+				Level _level;
+				char _text[LINE_SIZE];
+				size_t _length;
+
+				Record(const Record &other);
+				Record &operator=(const Record &other);
+
+			public:
+				Record(Category category, Level level);
+				~Record();
+
+				Record &append(const char *data, size_t length);
+				Record &operator<<(const char *str);
+				Record &operator<<(const std::string &str);
+				Record &operator<<(char c);
+				Record &operator<<(unsigned long number);
+				Record &operator<<(long number);
+				Record &operator<<(unsigned int number);
+				Record &operator<<(int number);
+		};
+
+	private:
+		struct Slot
+		{
+			volatile unsigned long sequence;
+			Category category;
+			Level level;
+			size_t length;
+			char text[LINE_SIZE];
+		};
+
+		static Level _thresholds[CATEGORY_COUNT];
+		static Slot _ring[RING_SIZE];
+		static volatile unsigned long _head;
+		static unsigned long _tail;
+		static volatile unsigned long _dropped;
+		static volatile int _draining;
+
+		static void push(Category category, Level level, const char *text, size_t length);
+		static void writeAll(const char *data, size_t length);
+
+		Logger();
+
+	public:
+		static bool enabled(Category category, Level level)
+		{
+			return level >= _thresholds[category];
+		}
+
+		// Setup
+		static void configure(const Config &config);
+		static void setLevel(Category category, Level level);
+
+		// Writes every queued record to stdout in one batch
+		static void flush();
+
+		// Static utility functions
+		static Level parseLevel(const std::string &name);
+		static const char *levelName(Level level);
+		static const char *categoryName(Category category);
+
+		// Exceptions
+		class UnknownLevel : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+};
+
+#endif
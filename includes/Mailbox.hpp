@@ -0,0 +1,110 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Mailbox.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/29 15:02:48 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/29 15:02:48 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef MAILBOX_HPP
+#define MAILBOX_HPP
+
+#include <string>
+#include <vector>
+#include <exception>
+#include <poll.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include "Connection.hpp"
+
+class ConnectionClass;
+
+// Many-producer, single-consumer queue between the hub and the workers.
+// Producers push onto a lock-free stack; the consumer takes the whole
+// stack at once and reverses it, so messages from one producer arrive in
+// the order they were posted. The eventfd is only written on the empty
+// to non-empty transition.
+class Mailbox
+{
+	public:
+		// Enough of a client for a channel shard to act on it
+		struct Identity
+		{
+			int id;
+			int worker;
+			std::string nickname;
+			std::string username;
+			std::string hostname;
+			const ConnectionClass *connectionClass;
+			Connection::Backlog *backlog;
+		};
+
+		struct Message
+		{
+			enum Type
+			{
+				CONNECT,		// worker -> hub: new connection and its backlog
+				INPUT,			// worker -> hub: complete lines, '\n' separated
+				DISCONNECT,		// worker/shard -> hub: the client must go, text is the reason
+				OUTPUT,			// hub/shard -> worker: bytes to append to the send queue
+				CLOSE,			// hub -> worker/shard: drop the connection
+				COMMAND,		// hub -> shard: a channel command and the clients it names
+				RENAME,			// hub -> shard: a client's identity changed
+				COLLECT,		// hub -> shard: list who shares a channel with the client
+				PEERS			// shard -> hub: answer to COLLECT, in ids
+			};
+
+			Type type;
+			int id;
+			int worker;
+			std::string text;
+			unsigned int overlong;
+			SendQueue output;
+			Connection::Backlog *backlog;
+			std::vector<Identity> identities;
+			std::vector<int> ids;
+			unsigned long request;
+			Message *next;
+
+			Message(Type type, int id);
+			~Message();
+
+			void attach(const Identity &identity);
+		};
+
+	private:
+		Message *volatile _head;
+		int _eventFd;
+
+		Mailbox(const Mailbox &other);
+		Mailbox &operator=(const Mailbox &other);
+
+	public:
+		Mailbox();
+		~Mailbox();
+
+		// Producers
+		void post(Message *message);
+		void wake();
+
+		// Consumer: returns the pending messages oldest first, or NULL
+		Message *collect();
+		int wait(int timeoutMs);
+
+		// Getters
+		int getFd() const;
+
+		// Exceptions
+		class MailboxFailed : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+};
+
+#endif
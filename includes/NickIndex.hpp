@@ -0,0 +1,59 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   NickIndex.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/21 11:40:27 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/21 11:40:27 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef NICKINDEX_HPP
+#define NICKINDEX_HPP
+
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+class Client;
+
+class NickIndex
+{
+	private:
+		struct Node
+		{
+			std::string key;
+			Client *client;
+			Node *next;
+		};
+
+		std::vector<Node *> _buckets;
+		size_t _size;
+
+		size_t bucketFor(const std::string &nick) const;
+		void rehash(size_t bucketCount);
+
+		NickIndex(const NickIndex &other);
+		NickIndex &operator=(const NickIndex &other);
+
+	public:
+		NickIndex();
+		~NickIndex();
+
+		// Lookup
+		Client *find(const std::string &nick) const;
+		size_t size() const;
+
+		// Modification
+		bool insert(const std::string &nick, Client *client);
+		void erase(const std::string &nick);
+
+		// RFC1459 casemapping
+		static char foldChar(char c);
+		static bool equals(const std::string &a, const std::string &b);
+		static uint32_t hash(const std::string &nick);
+};
+
+#endif
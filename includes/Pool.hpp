@@ -0,0 +1,218 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Pool.hpp                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/10/04 15:37:12 by soksak            #+#    #+#             */
+/*   Updated: 2025/10/04 15:37:12 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+
+#ifndef POOL_HPP
+#define POOL_HPP
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// Fixed-size blocks carved out of slabs, with freed blocks kept on a free
+// list for the next allocation. The first slab is sized from the config
+// at startup and later ones grow by the same amount. Slabs are only
+// returned when the pool is destroyed. Each Server owns its pools, so
+// they are never shared between threads and take no lock; only the
+// counters are read from the hub for STATS z, through snapshot().
+class Pool
+{
+	public:
+		struct Stats
+		{
+			size_t capacity;
+			size_t used;
+			size_t highWater;
+		};
+
+	private:
+		struct Block
+		{
+			Block *next;
+		};
+
+		const char *_name;
+		size_t _blockSize;
+		size_t _slabBlocks;
+		std::vector<char *> _slabs;
+		Block *_free;
+		size_t _capacity;
+		size_t _used;
+		size_t _highWater;
+
+		void grow();
+
+		Pool(const Pool &other);
+		Pool &operator=(const Pool &other);
+
+	public:
+		Pool(const char *name, size_t blockSize, size_t preallocate);
+		~Pool();
+
+		void *allocate();
+		void release(void *block);
+
+		// Getters
+		const char *getName() const;
+		size_t getBlockSize() const;
+		size_t getCapacity() const;
+		size_t getUsed() const;
+		size_t getHighWater() const;
+		Stats snapshot() const;
+};
+
+// A pool of T-sized blocks with construction on top
+template <typename T>
+class ObjectPool : public Pool
+{
+	public:
+		ObjectPool(const char *name, size_t preallocate) : Pool(name, sizeof(T), preallocate)
+		{
+		}
+
+		template <typename A1, typename A2>
+		T *create(const A1 &a1, A2 &a2)
+		{
+			void *block = allocate();
+			try
+			{
+				return new (block) T(a1, a2);
+			}
+			catch (...)
+			{
+				release(block);
+				throw;
+			}
+		}
+
+		template <typename A1, typename A2, typename A3>
+		T *create(const A1 &a1, const A2 &a2, A3 &a3)
+		{
+			void *block = allocate();
+			try
+			{
+				return new (block) T(a1, a2, a3);
+			}
+			catch (...)
+			{
+				release(block);
+				throw;
+			}
+		}
+
+		void destroy(T *object)
+		{
+			if (!object)
+				return;
+			object->~T();
+			release(object);
+		}
+};
+
+// Allocator for node-based containers: single nodes that fit a block come
+// from the pool, anything else (or any allocation without a pool) goes to
+// the heap. Containers keep a copy, so the pool must outlive them.
+template <typename T>
+class PoolAllocator
+{
+	template <typename U> friend class PoolAllocator;
+
+	private:
+		Pool *_pool;
+
+		bool pooled(size_t n) const
+		{
+			return _pool && n == 1 && sizeof(T) <= _pool->getBlockSize();
+		}
+
+	public:
+		typedef T value_type;
+		typedef T *pointer;
+		typedef const T *const_pointer;
+		typedef T &reference;
+		typedef const T &const_reference;
+		typedef size_t size_type;
+		typedef ptrdiff_t difference_type;
+
+		template <typename U>
+		struct rebind
+		{
+			typedef PoolAllocator<U> other;
+		};
+
+		PoolAllocator() throw() : _pool(NULL)
+		{
+		}
+
+		PoolAllocator(Pool *pool) throw() : _pool(pool)
+		{
+		}
+
+		template <typename U>
+		PoolAllocator(const PoolAllocator<U> &other) throw() : _pool(other._pool)
+		{
+		}
+
+		pointer address(reference value) const
+		{
+			return &value;
+		}
+
+		const_pointer address(const_reference value) const
+		{
+			return &value;
+		}
+
+		pointer allocate(size_type n, const void * = 0)
+		{
+			if (pooled(n))
+				return static_cast<pointer>(_pool->allocate());
+			return static_cast<pointer>(::operator new(n * sizeof(T)));
+		}
+
+		void deallocate(pointer p, size_type n)
+		{
+			if (pooled(n))
+				_pool->release(p);
+			else
+				::operator delete(p);
+		}
+
+		size_type max_size() const throw()
+		{
+			return size_t(-1) / sizeof(T);
+		}
+
+		void construct(pointer p, const T &value)
+		{
+			new (p) T(value);
+		}
+
+		void destroy(pointer p)
+		{
+			p->~T();
+		}
+
+		template <typename U>
+		bool operator==(const PoolAllocator<U> &other) const
+		{
+			return _pool == other._pool;
+		}
+
+		template <typename U>
+		bool operator!=(const PoolAllocator<U> &other) const
+		{
+			return _pool != other._pool;
+		}
+};
+
+#endif
@@ -0,0 +1,116 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reactor.hpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/20 14:02:11 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/20 14:02:11 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef REACTOR_HPP
+#define REACTOR_HPP
+
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdint.h>
+#include <exception>
+#include <iostream>
+#include "Logger.hpp"
+#include "Ring.hpp"
+
+class Connection;
+
+// With the io_uring backend the reactor only keeps the fd table and the
+// write interest bits; completions carry data rather than readiness, so
+// the worker drives its Ring directly.
+class Reactor
+{
+	public:
+		enum Backend
+		{
+			POLL,
+			EPOLL,
+			EPOLL_ET,
+			IO_URING
+		};
+
+		struct Event
+		{
+			int fd;
+			bool readable;
+			bool writable;
+		};
+
+	private:
+		struct Slot
+		{
+			int pollIndex;
+			Connection *connection;
+			short interest;
+			bool used;
+
+			Slot();
+		};
+
+		Backend _backend;
+		int _epollFd;
+		size_t _count;
+		std::vector<Slot> _slots;
+		std::vector<pollfd> _pollFds;
+		std::vector<epoll_event> _epollEvents;
+
+		Slot &slotFor(int fd);
+
+		void epollControl(int op, int fd, bool writable);
+		int waitPoll(std::vector<Event> &ready, int timeoutMs);
+		int waitEpoll(std::vector<Event> &ready, int timeoutMs);
+
+		Reactor(const Reactor &other);
+		Reactor &operator=(const Reactor &other);
+
+	public:
+		Reactor(Backend backend);
+		~Reactor();
+
+		// Interest management
+		void add(int fd, Connection *connection);
+		void setWritable(int fd, bool enabled);
+		void remove(int fd);
+
+		// Waiting
+		int wait(std::vector<Event> &ready, int timeoutMs);
+
+		// Getters
+		Connection *getConnection(int fd) const;
+		bool isWritable(int fd) const;
+		Backend getBackend() const;
+		bool isEdgeTriggered() const;
+		size_t size() const;
+
+		// Static utility functions
+		static Backend parseBackend(const std::string &name);
+		static const char *backendName(Backend backend);
+
+		// Exceptions
+		class ReactorControlFailed : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+
+		class UnknownBackend : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+};
+
+#endif
@@ -0,0 +1,51 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReplyBuffer.hpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/25 18:44:09 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/25 18:44:09 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef REPLYBUFFER_HPP
+#define REPLYBUFFER_HPP
+
+#include <string>
+#include <cstring>
+
+// One outgoing IRC line formatted in place. The content is capped at 510
+// bytes and is always followed by CRLF, so data() is ready to be queued.
+class ReplyBuffer
+{
+	public:
+		static const size_t MAX_CONTENT = 510;
+
+	private:
+		char _data[MAX_CONTENT + 2];
+		size_t _length;
+
+		void terminate();
+
+	public:
+		ReplyBuffer();
+
+		// Appending
+		ReplyBuffer &append(const char *data, size_t length);
+		ReplyBuffer &operator<<(const char *str);
+		ReplyBuffer &operator<<(const std::string &str);
+		ReplyBuffer &operator<<(char c);
+		ReplyBuffer &operator<<(unsigned long number);
+		ReplyBuffer &operator<<(long number);
+		ReplyBuffer &operator<<(unsigned int number);
+		ReplyBuffer &operator<<(int number);
+
+		// Getters
+		const char *data() const;
+		size_t length() const;
+		std::string str() const;
+};
+
+#endif
@@ -0,0 +1,107 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Ring.hpp                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/10/02 11:14:37 by soksak            #+#    #+#             */
+/*   Updated: 2025/10/02 11:14:37 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+
+#ifndef RING_HPP
+#define RING_HPP
+
+#include <exception>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <ctime>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+// A bare io_uring instance driven through the raw syscalls: the submission
+// and completion queues mapped from the kernel, plus one ring of provided
+// buffers that multishot receives pick from. Nothing is submitted until
+// submit() or wait(), so every request queued during an iteration goes to
+// the kernel in the same io_uring_enter.
+class Ring
+{
+	public:
+		struct Completion
+		{
+			uint64_t userData;
+			int result;
+			unsigned flags;
+		};
+
+		static const size_t BUFFER_SIZE = 4096;
+
+	private:
+		int _fd;
+		void *_map;
+		size_t _mapSize;
+		io_uring_sqe *_sqes;
+		size_t _sqesSize;
+		unsigned *_sqHead;
+		unsigned *_sqTail;
+		unsigned _sqMask;
+		unsigned _sqEntries;
+		unsigned _sqLocalTail;
+		unsigned *_cqHead;
+		unsigned *_cqTail;
+		unsigned _cqMask;
+		io_uring_cqe *_cqes;
+		io_uring_buf *_bufferRing;
+		size_t _bufferRingSize;
+		char *_buffers;
+		unsigned _bufferCount;
+
+		io_uring_sqe *nextSqe();
+		void setupBuffers(unsigned count);
+		void provideBuffer(unsigned id);
+		void release();
+		int enter(unsigned submit, unsigned waitFor, unsigned flags, void *arg, size_t argSize);
+
+		Ring(const Ring &other);
+		Ring &operator=(const Ring &other);
+
+	public:
+		Ring(unsigned entries, unsigned bufferCount);
+		~Ring();
+
+		// Requests
+		void accept(int fd, uint64_t userData);
+		void receive(int fd, uint64_t userData);
+		void sendMessage(int fd, const msghdr *message, uint64_t userData);
+		void pollReadable(int fd, uint64_t userData, bool multishot);
+		void pollWritable(int fd, uint64_t userData);
+		void cancel(uint64_t target);
+
+		// Submitting and reaping
+		int submit();
+		int wait(int timeoutMs);
+		bool next(Completion &completion);
+		bool hasPending() const;
+
+		// Provided buffers
+		const char *buffer(const Completion &completion) const;
+		void recycle(const Completion &completion);
+
+		static bool isSupported();
+
+		// Exceptions
+		class RingUnavailable : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+};
+
+#endif
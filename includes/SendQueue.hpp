@@ -0,0 +1,81 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SendQueue.hpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/22 16:05:48 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/22 16:05:48 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SENDQUEUE_HPP
+#define SENDQUEUE_HPP
+
+#include <string>
+#include <deque>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include "SharedPayload.hpp"
+
+class SendQueue
+{
+	public:
+		static const size_t CHUNK_SIZE = 4096;
+		static const size_t MIN_CHUNK_SIZE = 256;
+		static const size_t MAX_IOVECS = 64;
+
+	private:
+		// Header of a variable-sized block; the bytes follow it
+		struct Chunk
+		{
+			size_t length;
+			size_t capacity;
+
+			char *data();
+		};
+
+		struct Segment
+		{
+			Chunk *chunk;
+			SharedPayload *payload;
+
+			const char *data() const;
+			size_t length() const;
+		};
+
+		std::deque<Segment> _segments;
+		size_t _headOffset;
+		size_t _queuedBytes;
+
+		static Chunk *createChunk(size_t capacity);
+		static void releaseSegment(Segment &segment);
+
+		SendQueue(const SendQueue &other);
+		SendQueue &operator=(const SendQueue &other);
+
+	public:
+		SendQueue();
+		~SendQueue();
+
+		// Queueing
+		void append(const char *data, size_t length);
+		void append(const std::string &data);
+		void append(SharedPayload *payload);
+		void splice(SendQueue &other);
+		void clear();
+
+		// Writing
+		ssize_t flush(int fd);
+		size_t gather(struct iovec *iov, size_t max) const;
+		void consume(size_t bytes);
+
+		// Getters
+		bool empty() const;
+		size_t size() const;
+};
+
+#endif
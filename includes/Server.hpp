@@ -25,24 +25,91 @@
 #include "Client.hpp"
 #include <fcntl.h>
 #include <csignal>
+#include <cerrno>
 #include "IRCMessage.hpp"
 #include "CommandParser.hpp"
 #include "CommandExecuter.hpp"
 #include "Channel.hpp"
 #include "IRCResponse.hpp"
+#include "Config.hpp"
+#include "Reactor.hpp"
+#include "NickIndex.hpp"
+#include "Logger.hpp"
+#include "TimerWheel.hpp"
+#include "Mailbox.hpp"
+#include "Worker.hpp"
+#include "Pool.hpp"
 
 class Server
 {
+	public:
+		struct Stats
+		{
+			unsigned long sendqDropped;
+			unsigned long sendqExceeded;
+			unsigned long floodDeferred;
+			unsigned long floodExcess;
+
+			Stats();
+			Stats snapshot();
+		};
+
+		// A NICK or QUIT waiting for every shard to name the client's peers
+		struct PendingFanout
+		{
+			SharedPayload *payload;
+			int origin;
+			size_t waiting;
+			std::vector<int> peers;
+		};
+
+		// A red-black tree node: colour and three links ahead of the value
+		static const size_t MEMBERSHIP_NODE = 4 * sizeof(void *) + sizeof(std::pair<const int, Client *>);
+		static const size_t MAX_POOL = 1048576;
+		static const unsigned long MAX_TIMEOUT = 86400;
+		static const unsigned long LOG_FLUSH_MS = 1000;
+
 	private:
-		int serverSocket;
 		int port;
 		std::string password;
 		std::string hostname;
-		sockaddr_in serverAddress;
 		std::string creationTime;
+		ObjectPool<Client> clientPool;
+		ObjectPool<Channel> channelPool;
+		Pool membershipPool;
 		std::map<int, Client*> clients;
 		std::map<std::string, Channel*> channels;
-		std::vector<pollfd> poll_fds;
+		NickIndex nicknames;
+		Config config;
+		Throttle throttle;
+		std::vector<Worker*> workers;
+		bool threaded;
+		Mailbox inbox;
+		unsigned long fanoutEpoch;
+		TimerWheel timers;
+		TimerWheel::Timer logTimer;
+		unsigned long pingIntervalMs;
+		unsigned long pingTimeoutMs;
+		unsigned long registrationTimeoutMs;
+		size_t maxLineLength;
+		size_t readBudget;
+		size_t commandBudget;
+		size_t acceptBudget;
+		size_t ringBuffers;
+		unsigned long floodBurstMs;
+		size_t floodMaxDeferred;
+		std::vector<int> dirtyClients;
+		ConnectionClass unregisteredClass;
+		ConnectionClass userClass;
+		std::vector<int> closing;
+		Stats stats;
+		Server *hub;
+		std::vector<Server*> shards;
+		unsigned long nextRequest;
+		std::map<unsigned long, PendingFanout> pendingFanouts;
+		pthread_t shardThread;
+		bool shardStarted;
+		volatile bool shardStopping;
 
 		// Signal handling
 		static bool shouldStop;
@@ -50,6 +117,28 @@ class Server
 		// Private validation methods
 		void checkArgPort(const std::string &portStr);
 		void checkArgPassword(const std::string &password);
+		static size_t poolSize(const Config &config, const std::string &key, size_t fallback);
+		static unsigned long durationMs(const Config &config, const std::string &key, unsigned long fallback,
+			unsigned long min, unsigned long max);
+
+		// Flood control
+		void runLine(Client *client, const IRCMessage &ircMsg, const char *line, size_t length);
+		void deferLine(Client *client, const char *line, size_t length);
+		void drainDeferred(Client *client);
+		void scheduleDrain(Client *client);
+
+		// Channel shards
+		Server(Server &owner, size_t shardCount);
+		Server *shardFor(const IRCMessage &msg);
+		void forwardToShard(Server *shard, Client *client, const IRCMessage &msg, const char *line, size_t length);
+		void attachIdentity(Mailbox::Message *message, Client *client);
+		Client *adoptIdentity(const Mailbox::Identity &identity, bool create);
+		void leaveChannels(Client *client);
+		void handleShardMailbox();
+		void deliverFanout(PendingFanout &pending);
+		void finishFanout(int id);
+		void runShard();
+		static void *shardMain(void *shard);
 
 		// Private copy constructor and assignment operator
 		Server(const Server &other);
@@ -57,7 +146,7 @@ class Server
 		Server();
 	public:
 		// Constructor and Destructor
-		Server(const std::string &portStr, const std::string &password, const std::string &hostname);
+		Server(const std::string &portStr, const std::string &password, const std::string &hostname, const Config &config);
 		~Server();
 
 		// Main server methods
@@ -69,25 +158,52 @@ class Server
 
 		// Client management
 		void setNonBlocking(int fd);
-		void addClient(int client_fd);
+		Client* attachClient(int fd, int id);
+		void detachClient(Client* client);
+		Client* findClient(int id);
 		void removeClient(int client_fd);
-		void handleClientData(pollfd &clientPfd);
-		void sendToClient(pollfd &clientPfd, Client *client);
-		void markClientForSending(int client_fd);
+		void deliverLine(Client *client, const char *line, size_t length);
+		void deliverOverlong(Client *client);
+		void handleTimeout(Client *client);
+		void closeLater(Client *client, const std::string &reason);
+		void closePending();
+		void markClientForSending(Client *client);
+		void flushDirtyClients();
+
+		// Worker threads
+		void startWorkers();
+		void stopWorkers();
+		void handleMailbox();
+		void shipOutput(Client *client);
+		void broadcastToPeers(Client *client, const ReplyBuffer &reply, bool includeSelf);
 
 		// Getters
-		int getServerSocket() const;
 		int getPort() const;
 		const std::string& getPassword() const;
 		const std::string& getHostname() const;
 		std::map<int, Client*>& getClients();
 		std::map<std::string, Channel*>& getChannels();
+		Stats& getStats();
+		size_t getReadBudget() const;
+		size_t getCommandBudget() const;
+		size_t getAcceptBudget() const;
+		size_t getRingBuffers() const;
+		unsigned long getFloodBurst() const;
+		size_t getMaxLineLength() const;
+		const std::vector<Worker*>& getWorkers() const;
+		const std::vector<Server*>& getShards() const;
+		Mailbox& getInbox();
+		Throttle& getThrottle();
+		const Pool& getClientPool() const;
+		const Pool& getChannelPool() const;
+		const Pool& getMembershipPool() const;
 
 		// Channel management
 		Channel* createChannel(const std::string& name);
 		Channel* getChannel(const std::string& name);
 		void removeChannel(const std::string& name);
 		Client* getClientByNickname(const std::string& nickname);
+		void changeNickname(Client* client, const std::string& nickname);
 
 		// Client utilities
 		void sendWelcome(Client* client);
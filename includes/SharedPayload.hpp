@@ -0,0 +1,45 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SharedPayload.hpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/23 10:12:35 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/23 10:12:35 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef SHAREDPAYLOAD_HPP
+#define SHAREDPAYLOAD_HPP
+
+#include <string>
+#include <cstring>
+#include <new>
+
+class SharedPayload
+{
+	private:
+		size_t _length;
+		volatile unsigned int _refs;
+
+		SharedPayload(size_t length);
+		~SharedPayload();
+		SharedPayload(const SharedPayload &other);
+		SharedPayload &operator=(const SharedPayload &other);
+
+	public:
+		// Creation takes one allocation: the header followed by the bytes
+		static SharedPayload *create(const char *data, size_t length);
+		static SharedPayload *create(const std::string &data);
+
+		// Reference counting
+		void retain();
+		void release();
+
+		// Getters
+		const char *data() const;
+		size_t length() const;
+};
+
+#endif
@@ -0,0 +1,107 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Throttle.hpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/10/03 10:21:54 by soksak            #+#    #+#             */
+/*   Updated: 2025/10/03 10:21:54 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+
+#ifndef THROTTLE_HPP
+#define THROTTLE_HPP
+
+#include <string>
+#include <vector>
+#include <exception>
+#include <cstring>
+#include <ctime>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include "Config.hpp"
+
+// Admission control by peer address, consulted by the workers before a
+// connection is allocated. Each host gets a concurrent connection limit
+// and a token bucket for connects; both are off when set to 0. Hosts live
+// in an open-addressed table that is rebuilt without the idle ones once
+// it is half full. Workers share it, so it takes a lock.
+class Throttle
+{
+	public:
+		// IPv4 addresses are stored v4-mapped
+		struct Address
+		{
+			unsigned char bytes[16];
+
+			bool operator==(const Address &other) const;
+		};
+
+		enum Verdict
+		{
+			ADMIT,
+			TOO_MANY,
+			TOO_FAST
+		};
+
+	private:
+		struct Entry
+		{
+			Address address;
+			unsigned connections;
+			unsigned long tokens;
+			unsigned long refilledMs;
+			bool used;
+
+			Entry();
+		};
+
+		static const size_t INITIAL_SLOTS = 256;
+		// A connect costs one token; tokens are kept in units of 1/60000 so
+		// a rate given per minute refills by exactly `rate` units per ms.
+		static const unsigned long TOKEN = 60000;
+
+		unsigned _maxClients;
+		unsigned long _rate;
+		unsigned long _burst;
+		std::vector<Entry> _entries;
+		size_t _used;
+		pthread_mutex_t _lock;
+
+		Entry *find(const Address &address);
+		Entry &insert(const Address &address);
+		void refill(Entry &entry, unsigned long nowMs) const;
+		bool isIdle(Entry &entry, unsigned long nowMs) const;
+		void rebuild(unsigned long nowMs);
+		static size_t hash(const Address &address);
+		static unsigned long nowMs();
+
+		Throttle(const Throttle &other);
+		Throttle &operator=(const Throttle &other);
+
+	public:
+		Throttle(const Config &config);
+		~Throttle();
+
+		Verdict admit(const Address &address);
+		void release(const Address &address);
+		bool isEnabled() const;
+		size_t size();
+
+		// Static utility functions
+		static Address addressOf(const sockaddr *peer);
+		static std::string format(const Address &address);
+
+		// Exceptions
+		class InvalidLimits : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+};
+
+#endif
@@ -0,0 +1,89 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/27 16:05:52 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/27 16:05:52 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef TIMERWHEEL_HPP
+#define TIMERWHEEL_HPP
+
+#include <cstddef>
+#include <ctime>
+
+class Client;
+
+// Hierarchical timing wheel: 256 slots of TICK_MS at the first level and
+// three levels of 64 slots above it. Scheduling and cancelling are O(1);
+// a tick only touches the timers that expire or cascade down at it.
+class TimerWheel
+{
+	public:
+		static const unsigned long TICK_MS = 250;
+
+		struct Timer
+		{
+			Timer *prev;
+			Timer *next;
+			unsigned long expires;
+			Client *client;
+
+			Timer();
+			bool pending() const;
+		};
+
+	private:
+		static const int ROOT_BITS = 8;
+		static const int LEVEL_BITS = 6;
+		static const int LEVELS = 4;
+		static const size_t ROOT_SIZE = 1 << ROOT_BITS;
+		static const size_t LEVEL_SIZE = 1 << LEVEL_BITS;
+		static const unsigned long MAX_DELTA = (1UL << (ROOT_BITS + (LEVELS - 1) * LEVEL_BITS)) - 1;
+
+		Timer _root[ROOT_SIZE];
+		Timer _levels[LEVELS - 1][LEVEL_SIZE];
+		Timer _expired;
+		unsigned long _current;
+		unsigned long _startMs;
+		unsigned long _nowMs;
+		size_t _count;
+
+		static void initList(Timer &head);
+		static void link(Timer &head, Timer &timer);
+		static void unlink(Timer &timer);
+
+		void place(Timer &timer);
+		void cascade(int level);
+		void tick();
+
+		TimerWheel(const TimerWheel &other);
+		TimerWheel &operator=(const TimerWheel &other);
+
+	public:
+		TimerWheel();
+
+		// Scheduling
+		void schedule(Timer &timer, unsigned long delayMs);
+		void cancel(Timer &timer);
+
+		// Moves every timer due by now onto the expired list
+		void advance();
+		Timer *popExpired();
+
+		// Milliseconds until the next tick that has work, -1 when idle
+		int timeoutMs() const;
+
+		// Getters
+		unsigned long now() const;
+		size_t size() const;
+
+		// Static utility functions
+		static unsigned long monotonicMs();
+};
+
+#endif
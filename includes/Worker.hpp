@@ -0,0 +1,174 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Worker.hpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/29 15:40:13 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/29 15:40:13 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef WORKER_HPP
+#define WORKER_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <deque>
+#include <exception>
+#include <pthread.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "Reactor.hpp"
+#include "Ring.hpp"
+#include "Mailbox.hpp"
+#include "Connection.hpp"
+#include "Logger.hpp"
+
+class Server;
+
+// Owns a listening socket, a reactor and the connections accepted on it.
+// With one worker it runs inline on the server's loop and hands lines
+// straight to the command layer. With several, each one runs its own
+// thread on its own SO_REUSEPORT socket and only talks to the hub, which
+// owns every nick and channel, through mailboxes.
+//
+// With the io_uring backend the worker keeps one multishot accept and one
+// multishot receive per connection armed, and queues its sends on the ring
+// so one io_uring_enter per iteration submits them and waits.
+class Worker
+{
+	public:
+		// Bumped atomically by the worker, read by the hub for STATS
+		struct Stats
+		{
+			unsigned long readBudgetHits;
+			unsigned long commandBudgetHits;
+			unsigned long acceptRejected;
+			unsigned long acceptThrottled;
+
+			Stats();
+			Stats snapshot();
+		};
+
+	private:
+		enum RingOp
+		{
+			RING_CANCEL,
+			RING_ACCEPT,
+			RING_LISTEN,
+			RING_INBOX,
+			RING_RECEIVE,
+			RING_SEND,
+			RING_WRITABLE
+		};
+
+		struct RingSlot
+		{
+			unsigned generation;
+			bool receiving;
+			bool sending;
+			std::deque<Ring::Completion> held;
+			size_t heldOffset;
+
+			RingSlot();
+		};
+
+		struct RingSend
+		{
+			msghdr message;
+			iovec iov[SendQueue::MAX_IOVECS];
+		};
+
+		Server *_server;
+		int _index;
+		bool _threaded;
+		Reactor _reactor;
+		std::vector<Reactor::Event> _events;
+		int _listenSocket;
+		size_t _maxLineLength;
+		size_t _readBudget;
+		size_t _commandBudget;
+		size_t _acceptBudget;
+		bool _acceptPending;
+		int _reserveFd;
+		std::vector<int> _readyConnections;
+		std::vector<int> _dirtyConnections;
+		std::map<int, Connection*> _connections;
+		Mailbox _inbox;
+		pthread_t _thread;
+		bool _started;
+		volatile bool _stopping;
+		Stats _stats;
+		Ring *_ring;
+		std::vector<RingSlot> _ringSlots;
+		std::deque<RingSend> _ringSends;
+
+		static int nextId;
+
+		void acceptConnections();
+		bool rejectConnection();
+		bool admitConnection(int fd, const Throttle::Address &address);
+		void refuse(int fd, const char *message);
+		void addConnection(int fd, const Throttle::Address &address);
+		void handleData(Connection *connection);
+		bool processLines(Connection *connection, size_t &commandsLeft);
+		void markReadReady(Connection *connection);
+		void serviceReadyConnections();
+		void connectionLost(Connection *connection, const std::string &reason);
+		void dropConnection(Connection *connection);
+		void handleMailbox();
+		void markDirty(Connection *connection);
+		void flushDirtyConnections();
+		void sendToConnection(Connection *connection);
+		void run();
+		static void *threadMain(void *worker);
+
+		// io_uring
+		RingSlot &ringSlot(int fd);
+		uint64_t ringTag(RingOp op, int fd);
+		void ringComplete(const Ring::Completion &completion);
+		void ringAccepted(int fd);
+		void ringReceived(int fd, bool current, const Ring::Completion &completion);
+		void ringSent(Connection *connection, const Ring::Completion &completion);
+		void ringSend(Connection *connection);
+		bool ringFeed(Connection *connection, RingSlot &slot);
+		void ringForget(int fd);
+
+		Worker(const Worker &other);
+		Worker &operator=(const Worker &other);
+
+	public:
+		Worker(Server *server, int index, Reactor::Backend backend, bool threaded);
+		~Worker();
+
+		void listen(int port, bool reusePort);
+
+		// Inline mode: driven by the server's loop
+		int wait(int timeoutMs);
+		void dispatch();
+		bool hasReadyConnections() const;
+		void send(Connection *connection);
+		void closeConnection(Connection *connection);
+
+		// Threaded mode
+		void start();
+		void stop();
+		Mailbox& getInbox();
+
+		// Getters
+		Connection* getConnection(int fd) const;
+		Reactor::Backend getBackend() const;
+		Stats& getStats();
+
+		// Exceptions
+		class WorkerStartFailed : public std::exception
+		{
+			public:
+				const char *what() const throw();
+		};
+};
+
+#endif
@@ -14,23 +14,30 @@
 
 int main(int argc, char *argv[])
 {
-	if (argc != 3)
+	if (argc != 3 && argc != 4)
 	{
-		std::cerr << "Usage: " << argv[0] << " <port> <password>" << std::endl;
+		std::cerr << "Usage: " << argv[0] << " <port> <password> [config]" << std::endl;
 		return 1;
 	}
 
 	try
 	{
-		Server server(argv[1], argv[2], "localhost");
+		Config config;
+		if (argc == 4)
+			config.loadFile(argv[3]);
+		Logger::configure(config);
+
+		Server server(argv[1], argv[2], "localhost", config);
 		server.bindAndListen();
 		server.runServer();
 	}
 	catch (const std::exception &e)
 	{
+		Logger::flush();
 		std::cerr << "Error: " << e.what() << std::endl;
 		return 1;
 	}
 
+	Logger::flush();
 	return 0;
 }
@@ -13,14 +13,17 @@
 #include "../includes/Channel.hpp"
 #include "../includes/Server.hpp"
 
-Channel::Channel(const std::string &name) : _name(name), _topic(""), _key(""), _userLimit(0), _inviteOnly(false), _topicRestricted(true)
+Channel::Channel(const std::string &name, Pool &memberships)
+	: _name(name), _topic(""), _key(""), _userLimit(0), _inviteOnly(false), _topicRestricted(true),
+	  _users(std::less<int>(), &memberships), _operators(std::less<int>(), &memberships),
+	  _invited(std::less<int>(), &memberships)
 {
-	std::cout << "Channel " << _name << " created" << std::endl;
+	LOG(CHANNEL, DEBUG) << "Channel " << _name << " created";
 }
 
 Channel::~Channel()
 {
-	std::cout << "Channel " << _name << " destroyed" << std::endl;
+	LOG(CHANNEL, DEBUG) << "Channel " << _name << " destroyed";
 }
 
 const std::string &Channel::getName() const
@@ -45,28 +48,30 @@ bool Channel::addUser(Client *user)
 
 	int fd = user->getClientFd();
 	_users[fd] = user;
+	user->joinedChannel(this);
 
 	if (_users.size() == 1)
 	{
 		_operators[fd] = user;
-		std::cout << "User " << user->getNickname() << " added to channel " << _name << " as operator" << std::endl;
+		LOG(CHANNEL, DEBUG) << "User " << user->getNickname() << " added to channel " << _name << " as operator";
 	}
 	else
-		std::cout << "User " << user->getNickname() << " added to channel " << _name << std::endl;
+		LOG(CHANNEL, DEBUG) << "User " << user->getNickname() << " added to channel " << _name;
 
 	return true;
 }
 
 void Channel::removeUser(int fd)
 {
-	std::map<int, Client *>::iterator userIt = _users.find(fd);
+	Members::iterator userIt = _users.find(fd);
 	if (userIt != _users.end())
 	{
-		std::cout << "User " << userIt->second->getNickname() << " removed from channel " << _name << std::endl;
+		LOG(CHANNEL, DEBUG) << "User " << userIt->second->getNickname() << " removed from channel " << _name;
+		userIt->second->leftChannel(this);
 		_users.erase(userIt);
 	}
 
-	std::map<int, Client *>::iterator opIt = _operators.find(fd);
+	Members::iterator opIt = _operators.find(fd);
 	if (opIt != _operators.end())
 	{
 		_operators.erase(opIt);
@@ -75,7 +80,7 @@ void Channel::removeUser(int fd)
 
 bool Channel::isChannelEmpty() const
 {
-	std::map<int, Client *>::const_iterator it = _users.begin();
+	Members::const_iterator it = _users.begin();
 	if (it == _users.end())
 		return true;
 	return false;
@@ -86,6 +91,11 @@ bool Channel::isUserInChannel(int fd) const
 	return _users.find(fd) != _users.end();
 }
 
+const Channel::Members &Channel::getUsers() const
+{
+	return _users;
+}
+
 void Channel::addOperator(Client *user)
 {
 	if (!user)
@@ -96,7 +106,7 @@ void Channel::addOperator(Client *user)
 		return;
 
 	_operators[fd] = user;
-	std::cout << "User " << user->getNickname() << " is now operator in channel " << _name << std::endl;
+	LOG(CHANNEL, INFO) << "User " << user->getNickname() << " is now operator in channel " << _name;
 }
 
 bool Channel::isOperator(int fd) const
@@ -107,7 +117,7 @@ bool Channel::isOperator(int fd) const
 void Channel::setTopic(const std::string &topic)
 {
 	_topic = topic;
-	std::cout << "Topic for channel " << _name << " set to: " << topic << std::endl;
+	LOG(CHANNEL, INFO) << "Topic for channel " << _name << " set to: " << topic;
 }
 
 void Channel::setKey(const std::string &key)
@@ -168,39 +178,41 @@ void Channel::removeInvite(int fd)
 	_invited.erase(fd);
 }
 
-void Channel::broadcast(const std::string &message, Server *server, int exceptFd)
+void Channel::broadcast(const ReplyBuffer &reply, Server *server, int exceptFd, bool essential)
 {
-	for (std::map<int, Client *>::iterator it = _users.begin(); it != _users.end(); ++it)
+	SharedPayload *payload = SharedPayload::create(reply.data(), reply.length());
+
+	for (Members::iterator it = _users.begin(); it != _users.end(); ++it)
 	{
 		if (it->first != exceptFd)
-		{
-			it->second->appendToSendBuffer(message);
-			server->markClientForSending(it->first);
-		}
+			it->second->writeAndEnablePollOut(server, payload, essential);
 	}
+	payload->release();
 }
 
 void Channel::sendUserList(Server *server, Client *client)
 {
-	std::string namesList = "";
-	std::map<int, Client *> &users = server->getClients();
+	const std::string &nick = client->getNickname();
+	// ":server 353 <nick> = <channel> :" leaves this much room for names
+	size_t budget = ReplyBuffer::MAX_CONTENT - (18 + nick.length() + _name.length());
+	std::string namesList;
 
-	for (std::map<int, Client *>::iterator it = users.begin(); it != users.end(); ++it)
+	for (Members::iterator it = _users.begin(); it != _users.end(); ++it)
 	{
-		if (isUserInChannel(it->first))
-		{
-			if (!namesList.empty())
-				namesList += " ";
+		std::string entry = isOperator(it->first) ? "@" + it->second->getNickname() : it->second->getNickname();
 
-			if (isOperator(it->first))
-				namesList += "@";
-
-			namesList += it->second->getNickname();
+		if (!namesList.empty() && namesList.length() + 1 + entry.length() > budget)
+		{
+			client->writeAndEnablePollOut(server, IRCResponse::createNamReply(nick, _name, namesList));
+			namesList.clear();
 		}
+		if (!namesList.empty())
+			namesList += " ";
+		namesList += entry;
 	}
 
-	client->writeAndEnablePollOut(server, IRCResponse::createNamReply(client->getNickname(), _name, namesList));
-	client->writeAndEnablePollOut(server, IRCResponse::createEndOfNames(client->getNickname(), _name));
+	client->writeAndEnablePollOut(server, IRCResponse::createNamReply(nick, _name, namesList));
+	client->writeAndEnablePollOut(server, IRCResponse::createEndOfNames(nick, _name));
 }
 
 bool Channel::isValidChannelName(const std::string &channelName)
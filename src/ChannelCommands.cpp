@@ -16,33 +16,11 @@
 #include "../includes/Channel.hpp"
 #include "../includes/ModeHandler.hpp"
 
-bool ChannelCommands::validateBasicCommand(Server *server, Client *client, const IRCMessage &msg, const std::string &commandName)
-{
-	if (!client->isRegistered())
-	{
-		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorNotRegistered(client->getNickname()));
-		return false;
-	}
-
-	if (msg.getParams().empty())
-	{
-		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorNeedMoreParams(client->getNickname(), commandName));
-		return false;
-	}
-
-	return true;
-}
-
 void ChannelCommands::handleJOIN(Server *server, Client *client, const IRCMessage &msg)
 {
-	if (!validateBasicCommand(server, client, msg, "JOIN"))
-		return;
-
-	std::string channelName = msg.getParams()[0];
+	std::string channelName = msg.getParam(0);
 
-	if (channelName[0] != '#')
+	if (channelName.empty() || channelName[0] != '#')
 	{
 		channelName = "#" + channelName;
 	}
@@ -60,7 +38,7 @@ void ChannelCommands::handleJOIN(Server *server, Client *client, const IRCMessag
 		channel = server->createChannel(channelName);
 		if (!channel)
 		{
-			std::cout << "Error: Failed to create channel " << channelName << std::endl;
+			LOG(CHANNEL, ERROR) << "Failed to create channel " << channelName;
 			return;
 		}
 	}
@@ -68,9 +46,9 @@ void ChannelCommands::handleJOIN(Server *server, Client *client, const IRCMessag
 	if (!channel->getKey().empty())
 	{
 		std::string providedKey;
-		if (msg.getParams().size() > 1)
+		if (msg.paramCount() > 1)
 		{
-			providedKey = msg.getParams()[1];
+			providedKey = msg.getParam(1);
 		}
 
 		if (providedKey != channel->getKey())
@@ -106,8 +84,7 @@ void ChannelCommands::handleJOIN(Server *server, Client *client, const IRCMessag
 	{
 		channel->removeInvite(client->getClientFd());
 
-		channel->broadcast(IRCResponse::createJoin(client->getNickname(),
-			client->getUsername(), server->getHostname(), channelName), server, -1);
+		channel->broadcast(IRCResponse::createJoin(client->getPrefix(), channelName), server, -1);
 
 		channel->sendUserList(server, client);
 
@@ -124,15 +101,12 @@ void ChannelCommands::handleJOIN(Server *server, Client *client, const IRCMessag
 			IRCResponse::createModeReply(client->getNickname(), channelName, fullModes));
 	}
 	else
-		std::cout << "Failed to add user " << client->getNickname() << " to channel " << channelName << std::endl;
+		LOG(CHANNEL, WARN) << "Failed to add user " << client->getNickname() << " to channel " << channelName;
 }
 
 void ChannelCommands::handlePART(Server *server, Client *client, const IRCMessage &msg)
 {
-	if (!validateBasicCommand(server, client, msg, "PART"))
-		return;
-
-	std::string channelName = msg.getParams()[0];
+	std::string channelName = msg.getParam(0);
 	Channel *channel = server->getChannel(channelName);
 
 	if (!channel)
@@ -149,9 +123,9 @@ void ChannelCommands::handlePART(Server *server, Client *client, const IRCMessag
 		return;
 	}
 
-	std::string reason = msg.getTrailing().empty() ? "Leaving" : msg.getTrailing();
+	std::string reason = msg.isTrailingEmpty() ? "Leaving" : msg.getTrailing();
 
-	std::string partMsg = IRCResponse::createPart(client->getNickname(), client->getUsername(), server->getHostname(), channelName);
+	ReplyBuffer partMsg = IRCResponse::createPart(client->getPrefix(), channelName);
 	channel->broadcast(partMsg, server, -1);
 
 	channel->removeUser(client->getClientFd());
@@ -164,23 +138,9 @@ void ChannelCommands::handlePART(Server *server, Client *client, const IRCMessag
 
 void ChannelCommands::handleKICK(Server *server, Client *client, const IRCMessage &msg)
 {
-	if (!client->isRegistered())
-	{
-		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorNotRegistered(client->getNickname()));
-		return;
-	}
-
-	if (msg.getParams().size() < 2)
-	{
-		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorNeedMoreParams(client->getNickname(), "KICK"));
-		return;
-	}
-
-	std::string channelName = msg.getParams()[0];
-	std::string targetNick = msg.getParams()[1];
-	std::string reason = msg.getTrailing().empty() ? "No reason given" : msg.getTrailing();
+	std::string channelName = msg.getParam(0);
+	std::string targetNick = msg.getParam(1);
+	std::string reason = msg.isTrailingEmpty() ? "No reason given" : msg.getTrailing();
 
 	Channel *channel = server->getChannel(channelName);
 	if (!channel)
@@ -219,7 +179,7 @@ void ChannelCommands::handleKICK(Server *server, Client *client, const IRCMessag
 		return;
 	}
 
-	std::string kickMsg = IRCResponse::createKick(client->getNickname(), client->getUsername(), server->getHostname(), channelName, targetNick, reason);
+	ReplyBuffer kickMsg = IRCResponse::createKick(client->getPrefix(), channelName, targetNick, reason);
 	channel->broadcast(kickMsg, server, -1);
 
 	channel->removeUser(targetClient->getClientFd());
@@ -229,27 +189,13 @@ void ChannelCommands::handleKICK(Server *server, Client *client, const IRCMessag
 		server->removeChannel(channelName);
 	}
 
-	std::cout << "User " << targetNick << " was kicked from " << channelName << " by " << client->getNickname() << std::endl;
+	LOG(CHANNEL, INFO) << "User " << targetNick << " was kicked from " << channelName << " by " << client->getNickname();
 }
 
 void ChannelCommands::handleINVITE(Server *server, Client *client, const IRCMessage &msg)
 {
-	if (!client->isRegistered())
-	{
-		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorNotRegistered(client->getNickname()));
-		return;
-	}
-
-	if (msg.getParams().size() < 2)
-	{
-		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorNeedMoreParams(client->getNickname(), "INVITE"));
-		return;
-	}
-
-	std::string targetNick = msg.getParams()[0];
-	std::string channelName = msg.getParams()[1];
+	std::string targetNick = msg.getParam(0);
+	std::string channelName = msg.getParam(1);
 
 	Client *targetClient = server->getClientByNickname(targetNick);
 	if (!targetClient)
@@ -282,22 +228,19 @@ void ChannelCommands::handleINVITE(Server *server, Client *client, const IRCMess
 	}
 
 	targetClient->writeAndEnablePollOut(server,
-		IRCResponse::createInvite(client->getNickname(), client->getUsername(), server->getHostname(), targetNick, channelName));
+		IRCResponse::createInvite(client->getPrefix(), targetNick, channelName));
 
 	channel->inviteUser(targetClient->getClientFd());
 
 	client->writeAndEnablePollOut(server,
 		IRCResponse::createInviting(client->getNickname(), targetNick, channelName));
 
-	std::cout << "User " << client->getNickname() << " invited " << targetNick << " to " << channelName << std::endl;
+	LOG(CHANNEL, INFO) << "User " << client->getNickname() << " invited " << targetNick << " to " << channelName;
 }
 
 void ChannelCommands::handleTOPIC(Server *server, Client *client, const IRCMessage &msg)
 {
-	if (!validateBasicCommand(server, client, msg, "TOPIC"))
-		return;
-
-	std::string channelName = msg.getParams()[0];
+	std::string channelName = msg.getParam(0);
 	Channel *channel = server->getChannel(channelName);
 
 	if (!channel)
@@ -314,7 +257,7 @@ void ChannelCommands::handleTOPIC(Server *server, Client *client, const IRCMessa
 		return;
 	}
 
-	if (msg.getTrailing().empty())
+	if (msg.isTrailingEmpty())
 	{
 		std::string currentTopic = channel->getTopic();
 		if (currentTopic.empty())
@@ -340,8 +283,8 @@ void ChannelCommands::handleTOPIC(Server *server, Client *client, const IRCMessa
 	std::string newTopic = msg.getTrailing();
 	channel->setTopic(newTopic);
 
-	std::string topicMsg = IRCResponse::createTopic(client->getNickname(), client->getUsername(), server->getHostname(), channelName, newTopic);
+	ReplyBuffer topicMsg = IRCResponse::createTopic(client->getPrefix(), channelName, newTopic);
 	channel->broadcast(topicMsg, server, -1);
 
-	std::cout << "Topic for " << channelName << " set to: " << newTopic << std::endl;
+	LOG(CHANNEL, INFO) << "Topic for " << channelName << " set to: " << newTopic;
 }
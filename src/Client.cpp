@@ -13,20 +13,25 @@
 #include "../includes/Client.hpp"
 #include "../includes/Server.hpp"
 
-Client::Client(int client_fd) : _client_fd(client_fd), _isRegistered(false),
-								_hasPassword(false), _hasNick(false), _hasUser(false)
+Client::Client(int fd, int id, Pool &memberships) : Connection(fd, id),
+								_channels(std::less<Channel *>(), &memberships), _isRegistered(false),
+								_hasPassword(false), _hasNick(false), _hasUser(false), _fanoutMark(0), _fanoutsPending(0),
+								_lastActivity(0), _awaitingPong(false), _class(NULL), _worker(0),
+								_floodClock(0), _deferredBytes(0), _floodPenalties(0)
 {
-	std::cout << "Client " << client_fd << " created." << std::endl;
+	_timer.client = this;
+	_floodTimer.client = this;
+	LOG(NET, DEBUG) << "Client " << id << " created.";
 }
 
 Client::~Client()
 {
-	std::cout << "Client " << _client_fd << " destroyed." << std::endl;
+	LOG(NET, DEBUG) << "Client " << _id << " destroyed.";
 }
 
 int Client::getClientFd() const
 {
-	return _client_fd;
+	return _id;
 }
 
 const std::string& Client::getNickname() const
@@ -44,17 +49,17 @@ const std::string& Client::getRealname() const
 	return _realname;
 }
 
-
-std::string& Client::getReadBuffer()
+const std::string& Client::getHostname() const
 {
-	return _readBuffer;
+	return _hostname;
 }
 
-std::string& Client::getSendBuffer()
+const std::string& Client::getPrefix() const
 {
-	return _sendBuffer;
+	return _prefix;
 }
 
+
 bool Client::isRegistered() const
 {
 	return _isRegistered;
@@ -75,10 +80,41 @@ bool Client::hasUser() const
 	return _hasUser;
 }
 
+const Client::ChannelSet& Client::getChannels() const
+{
+	return _channels;
+}
+
+TimerWheel::Timer& Client::getTimer()
+{
+	return _timer;
+}
+
+unsigned long Client::getLastActivity() const
+{
+	return _lastActivity;
+}
+
+bool Client::isAwaitingPong() const
+{
+	return _awaitingPong;
+}
+
+const ConnectionClass* Client::getConnectionClass() const
+{
+	return _class;
+}
+
+int Client::getWorker() const
+{
+	return _worker;
+}
+
 void Client::setNickname(const std::string& nickname)
 {
 	_nickname = nickname;
 	_hasNick = true;
+	updatePrefix();
 	updateRegistrationStatus();
 }
 
@@ -86,6 +122,7 @@ void Client::setUsername(const std::string& username)
 {
 	_username = username;
 	_hasUser = true;
+	updatePrefix();
 	updateRegistrationStatus();
 }
 
@@ -94,6 +131,12 @@ void Client::setRealname(const std::string& realname)
 	_realname = realname;
 }
 
+void Client::setHostname(const std::string& hostname)
+{
+	_hostname = hostname;
+	updatePrefix();
+}
+
 void Client::setPassword(bool has)
 {
 	_hasPassword = has;
@@ -105,14 +148,127 @@ void Client::setRegistered(bool registered)
 	_isRegistered = registered;
 }
 
-void Client::appendToReadBuffer(const std::string& data)
+// Source prefix spliced into every line this client originates
+void Client::updatePrefix()
+{
+	_prefix.clear();
+	_prefix.reserve(_nickname.length() + _username.length() + _hostname.length() + 3);
+	_prefix += ':';
+	_prefix += _nickname;
+	_prefix += '!';
+	_prefix += _username;
+	_prefix += '@';
+	_prefix += _hostname;
+}
+
+void Client::setAwaitingPong(bool awaiting)
+{
+	_awaitingPong = awaiting;
+}
+
+void Client::touch(unsigned long nowMs)
+{
+	_lastActivity = nowMs;
+}
+
+TimerWheel::Timer& Client::getFloodTimer()
+{
+	return _floodTimer;
+}
+
+unsigned long Client::getFloodLag(unsigned long nowMs) const
+{
+	return _floodClock > nowMs ? _floodClock - nowMs : 0;
+}
+
+bool Client::hasDeferredLines() const
+{
+	return !_deferredLines.empty();
+}
+
+size_t Client::getDeferredBytes() const
+{
+	return _deferredBytes;
+}
+
+unsigned long Client::getFloodPenalties() const
+{
+	return _floodPenalties;
+}
+
+void Client::chargeFlood(unsigned long nowMs, unsigned long costMs)
+{
+	if (_floodClock < nowMs)
+		_floodClock = nowMs;
+	_floodClock += costMs;
+}
+
+void Client::deferLine(const char* line, size_t length)
 {
-	_readBuffer += data;
+	_deferredLines.push_back(std::string(line, length));
+	_deferredBytes += length;
+}
+
+void Client::addFloodPenalty()
+{
+	++_floodPenalties;
+}
+
+std::string Client::popDeferredLine()
+{
+	std::string line;
+	line.swap(_deferredLines.front());
+	_deferredLines.pop_front();
+	_deferredBytes -= line.length();
+	return line;
+}
+
+void Client::setConnectionClass(const ConnectionClass* connectionClass)
+{
+	_class = connectionClass;
+}
+
+void Client::setWorker(int worker)
+{
+	_worker = worker;
+}
+
+void Client::joinedChannel(Channel* channel)
+{
+	_channels.insert(channel);
+}
+
+void Client::leftChannel(Channel* channel)
+{
+	_channels.erase(channel);
+}
+
+bool Client::markForFanout(unsigned long epoch)
+{
+	if (_fanoutMark == epoch)
+		return false;
+	_fanoutMark = epoch;
+	return true;
+}
+
+void Client::beginFanout()
+{
+	++_fanoutsPending;
+}
+
+unsigned int Client::endFanout()
+{
+	return --_fanoutsPending;
+}
+
+bool Client::isFanoutPending() const
+{
+	return _fanoutsPending > 0;
 }
 
 void Client::appendToSendBuffer(const std::string& data)
 {
-	_sendBuffer += data;
+	_sendQueue.append(data);
 }
 
 void Client::clearReadBuffer()
@@ -122,7 +278,7 @@ void Client::clearReadBuffer()
 
 void Client::clearSendBuffer()
 {
-	_sendBuffer.clear();
+	_sendQueue.clear();
 }
 
 void Client::updateRegistrationStatus()
@@ -130,14 +286,46 @@ void Client::updateRegistrationStatus()
 	if (_hasPassword && _hasNick && _hasUser && !_isRegistered)
 	{
 		_isRegistered = true;
-		std::cout << "Client " << _client_fd << " is now fully registered!" << std::endl;
+		LOG(COMMAND, INFO) << "Client " << _id << " is now fully registered!";
 	}
 }
 
-void Client::writeAndEnablePollOut(Server* server, const std::string& message)
+// Past the soft limit only essential lines are queued; a line that would
+// cross the hard limit gets the client closed at the end of the loop.
+bool Client::admitToSendQueue(Server* server, size_t length, bool essential)
 {
-	appendToSendBuffer(message);
-	server->markClientForSending(_client_fd);
+	if (_closing)
+		return false;
+
+	size_t queued = pendingBytes();
+	if (queued + length > _class->getSendqHard())
+	{
+		__sync_fetch_and_add(&server->getStats().sendqExceeded, 1);
+		server->closeLater(this, "SendQ exceeded");
+		return false;
+	}
+	if (!essential && queued >= _class->getSendqSoft())
+	{
+		__sync_fetch_and_add(&server->getStats().sendqDropped, 1);
+		return false;
+	}
+	return true;
+}
+
+void Client::writeAndEnablePollOut(Server* server, const ReplyBuffer& reply, bool essential)
+{
+	if (!admitToSendQueue(server, reply.length(), essential))
+		return;
+	_sendQueue.append(reply.data(), reply.length());
+	server->markClientForSending(this);
+}
+
+void Client::writeAndEnablePollOut(Server* server, SharedPayload* payload, bool essential)
+{
+	if (!admitToSendQueue(server, payload->length(), essential))
+		return;
+	_sendQueue.append(payload);
+	server->markClientForSending(this);
 }
 
 bool Client::isValidNickname(const std::string& nickname)
@@ -163,11 +351,6 @@ bool Client::isValidNickname(const std::string& nickname)
 
 bool Client::isNicknameInUse(Server* server, const std::string& nickname, int excludeFd)
 {
-	std::map<int, Client*>& clients = server->getClients();
-	for (std::map<int, Client*>::iterator it = clients.begin(); it != clients.end(); ++it)
-	{
-		if (it->first != excludeFd && it->second->getNickname() == nickname)
-			return true;
-	}
-	return false;
-}
+	Client* owner = server->getClientByNickname(nickname);
+	return owner && owner->getClientFd() != excludeFd;
+}
\ No newline at end of file
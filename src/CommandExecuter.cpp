@@ -16,53 +16,74 @@
 #include "../includes/Channel.hpp"
 #include "../includes/ModeHandler.hpp"
 
+// Costs are flood penalties in milliseconds
+CommandExecuter::CommandEntry CommandExecuter::commandTable[CMD_COUNT] = {
+	{ "",        NULL,                            true,  0, 1000, 0 },
+	{ "PASS",    &CommandExecuter::handlePASS,    true,  0, 500,  0 },
+	{ "NICK",    &CommandExecuter::handleNICK,    true,  0, 2000, 0 },
+	{ "USER",    &CommandExecuter::handleUSER,    true,  0, 500,  0 },
+	{ "PING",    &CommandExecuter::handlePING,    true,  0, 500,  0 },
+	{ "PONG",    &CommandExecuter::handlePONG,    true,  0, 0,    0 },
+	{ "QUIT",    &CommandExecuter::handleQUIT,    true,  0, 0,    0 },
+	{ "JOIN",    &ChannelCommands::handleJOIN,    false, 1, 2000, 0 },
+	{ "PART",    &ChannelCommands::handlePART,    false, 1, 1000, 0 },
+	{ "KICK",    &ChannelCommands::handleKICK,    false, 2, 1000, 0 },
+	{ "INVITE",  &ChannelCommands::handleINVITE,  false, 2, 2000, 0 },
+	{ "TOPIC",   &ChannelCommands::handleTOPIC,   false, 1, 1000, 0 },
+	{ "MODE",    &ModeHandler::handleMODE,        false, 1, 1000, 0 },
+	{ "PRIVMSG", &CommandExecuter::handlePRIVMSG, false, 1, 1000, 0 },
+	{ "STATS",   &CommandExecuter::handleSTATS,   false, 0, 2000, 0 }
+};
+
+const CommandExecuter::CommandEntry &CommandExecuter::getCommandEntry(CommandId id)
+{
+	return commandTable[id];
+}
+
 void CommandExecuter::executeCommand(Server *server, Client *client, const IRCMessage &msg)
+{
+	Handler handler = admitCommand(server, client, msg);
+	if (handler)
+		handler(server, client, msg);
+}
+
+// Counts the command and answers the generic errors; returns the handler
+// to run, or NULL if the command stops here.
+CommandExecuter::Handler CommandExecuter::admitCommand(Server *server, Client *client, const IRCMessage &msg)
 {
 	if (!server || !client)
 	{
-		std::cout << "Error: Invalid server or client pointer" << std::endl;
-		return;
+		LOG(COMMAND, ERROR) << "Invalid server or client pointer";
+		return NULL;
+	}
+
+	CommandEntry &entry = commandTable[msg.getCommandId()];
+	if (!entry.handler)
+	{
+		LOG(COMMAND, DEBUG) << "Unknown command: " << msg.getCommand();
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createErrorUnknownCommand(client->getNickname(), msg.getCommand()));
+		return NULL;
 	}
 
-	std::string cmd = msg.getCommand();
+	++entry.calls;
+	LOG(COMMAND, DEBUG) << "Executing command: " << entry.name << " for client " << client->getClientFd();
 
-	for (size_t i = 0; i < cmd.length(); ++i)
+	if (!entry.allowedUnregistered && !client->isRegistered())
 	{
-		cmd[i] = std::toupper(cmd[i]);
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createErrorNotRegistered(client->getNickname()));
+		return NULL;
 	}
 
-	std::cout << "Executing command: " << cmd << " for client " << client->getClientFd() << std::endl;
-
-	if (cmd == "PASS")
-		handlePASS(server, client, msg);
-	else if (cmd == "NICK")
-		handleNICK(server, client, msg);
-	else if (cmd == "USER")
-		handleUSER(server, client, msg);
-	else if (cmd == "PING")
-		handlePING(server, client, msg);
-	else if (cmd == "QUIT")
-		handleQUIT(server, client, msg);
-	else if (cmd == "JOIN")
-		ChannelCommands::handleJOIN(server, client, msg);
-	else if (cmd == "PART")
-		ChannelCommands::handlePART(server, client, msg);
-	else if (cmd == "KICK")
-		ChannelCommands::handleKICK(server, client, msg);
-	else if (cmd == "INVITE")
-		ChannelCommands::handleINVITE(server, client, msg);
-	else if (cmd == "TOPIC")
-		ChannelCommands::handleTOPIC(server, client, msg);
-	else if (cmd == "MODE")
-		ModeHandler::handleMODE(server, client, msg);
-	else if (cmd == "PRIVMSG")
-		handlePRIVMSG(server, client, msg);
-	else
+	if (msg.paramCount() < entry.minParams)
 	{
-		std::cout << "Unknown command: " << cmd << std::endl;
 		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorUnknownCommand(client->getNickname(), cmd));
+			IRCResponse::createErrorNeedMoreParams(client->getNickname(), entry.name));
+		return NULL;
 	}
+
+	return entry.handler;
 }
 
 void CommandExecuter::handlePASS(Server *server, Client *client, const IRCMessage &msg)
@@ -74,19 +95,19 @@ void CommandExecuter::handlePASS(Server *server, Client *client, const IRCMessag
 		return;
 	}
 
-	if (msg.getParams().empty())
+	if (msg.paramCount() == 0)
 	{
 		client->writeAndEnablePollOut(server,
 			IRCResponse::createErrorNeedMoreParams("*", "PASS"));
 		return;
 	}
 
-	std::string password = msg.getParams()[0];
+	std::string password = msg.getParam(0);
 
 	if (password == server->getPassword())
 	{
 		client->setPassword(true);
-		std::cout << "Client " << client->getClientFd() << " provided correct password" << std::endl;
+		LOG(COMMAND, INFO) << "Client " << client->getClientFd() << " provided correct password";
 		client->writeAndEnablePollOut(server,
 			IRCResponse::createNotice("*", "Password accepted"));
 	}
@@ -94,7 +115,7 @@ void CommandExecuter::handlePASS(Server *server, Client *client, const IRCMessag
 	{
 		client->writeAndEnablePollOut(server,
 			IRCResponse::createErrorPasswdMismatch("*"));
-		std::cout << "Client " << client->getClientFd() << " provided wrong password" << std::endl;
+		LOG(COMMAND, WARN) << "Client " << client->getClientFd() << " provided wrong password";
 	}
 }
 
@@ -103,7 +124,7 @@ void CommandExecuter::handleNICK(Server *server, Client *client, const IRCMessag
 	if (!client->hasPassword())
 		return;
 
-	if (msg.getParams().empty())
+	if (msg.paramCount() == 0)
 	{
 		std::string currentNick = client->getNickname().empty() ? "*" : client->getNickname();
 		client->writeAndEnablePollOut(server,
@@ -111,7 +132,7 @@ void CommandExecuter::handleNICK(Server *server, Client *client, const IRCMessag
 		return;
 	}
 
-	std::string newNick = msg.getParams()[0];
+	std::string newNick = msg.getParam(0);
 
 	if (!Client::isValidNickname(newNick))
 	{
@@ -129,23 +150,15 @@ void CommandExecuter::handleNICK(Server *server, Client *client, const IRCMessag
 		return;
 	}
 
-	std::string oldNick = client->getNickname();
+	bool hadNick = !client->getNickname().empty();
+	ReplyBuffer nickMsg = IRCResponse::createNickChange(client->getPrefix(), newNick);
 
-	client->setNickname(newNick);
-	std::cout << "Client " << client->getClientFd() << " set nickname to: " << newNick << std::endl;
+	server->changeNickname(client, newNick);
+	LOG(COMMAND, INFO) << "Client " << client->getClientFd() << " set nickname to: " << newNick;
 
-	if (!oldNick.empty())
+	if (hadNick)
 	{
-		std::map<std::string, Channel *> &channels = server->getChannels();
-		for (std::map<std::string, Channel *>::iterator it = channels.begin(); it != channels.end(); ++it)
-		{
-			Channel *channel = it->second;
-			if (channel && channel->isUserInChannel(client->getClientFd()))
-			{
-				channel->broadcast(IRCResponse::createNickChange(oldNick, client->getUsername(), server->getHostname(),
-					 newNick), server, -1);
-			}
-		}
+		server->broadcastToPeers(client, nickMsg, true);
 		return;
 	}
 
@@ -165,7 +178,7 @@ void CommandExecuter::handleUSER(Server *server, Client *client, const IRCMessag
 		return;
 	}
 
-	if (msg.getParams().size() < 3 || msg.getTrailing().empty())
+	if (msg.paramCount() < 3 || msg.isTrailingEmpty())
 	{
 		std::string currentNick = client->getNickname().empty() ? "*" : client->getNickname();
 		client->writeAndEnablePollOut(server,
@@ -173,13 +186,13 @@ void CommandExecuter::handleUSER(Server *server, Client *client, const IRCMessag
 		return;
 	}
 
-	std::string username = msg.getParams()[0];
+	std::string username = msg.getParam(0);
 	std::string realname = msg.getTrailing();
 
 	client->setUsername(username);
 	client->setRealname(realname);
 
-	std::cout << "Client " << client->getClientFd() << " set username to: " << username << ", realname: " << realname << std::endl;
+	LOG(COMMAND, INFO) << "Client " << client->getClientFd() << " set username to: " << username << ", realname: " << realname;
 
 	if (client->isRegistered())
 	{
@@ -192,96 +205,60 @@ void CommandExecuter::handlePING(Server *server, Client *client, const IRCMessag
 	if (!client->hasPassword())
 		return;
 
-	if (msg.getParams().empty())
+	if (msg.paramCount() == 0 && msg.isTrailingEmpty())
 	{
 		client->writeAndEnablePollOut(server,
 			IRCResponse::createErrorNeedMoreParams(client->getNickname(), "PING"));
 		return;
 	}
+	std::string token = msg.paramCount() > 0 ? msg.getParam(0) : msg.getTrailing();
 	client->writeAndEnablePollOut(server,
-		IRCResponse::createPong(server->getHostname(), msg.getParams()[0]));
+		IRCResponse::createPong(server->getHostname(), token));
+}
+
+void CommandExecuter::handlePONG(Server *server, Client *client, const IRCMessage &msg)
+{
+	(void)server;
+	(void)msg;
+	client->setAwaitingPong(false);
 }
 
 void CommandExecuter::handleDisconnection(Server *server, Client *client, const std::string message)
 {
 	if (!client->getNickname().empty())
 	{
-		std::map<std::string, Channel *> &channels = server->getChannels();
-		for (std::map<std::string, Channel *>::iterator it = channels.begin(); it != channels.end(); ++it)
-		{
-			Channel *channel = it->second;
-			if (channel && channel->isUserInChannel(client->getClientFd()))
-			{
-				channel->broadcast(IRCResponse::createQUIT(client->getNickname(), client->getUsername(),
-					server->getHostname(), message), server, -1);
-			}
-		}
+		server->broadcastToPeers(client, IRCResponse::createQUIT(client->getPrefix(), message), false);
 	}
 	server->removeClient(client->getClientFd());
 }
 
 void CommandExecuter::handleQUIT(Server *server, Client *client, const IRCMessage &msg)
 {
-	std::string quit_msg = msg.getTrailing().empty() ? "Client Quit" : msg.getTrailing();
-	std::cout << "Client " << client->getClientFd() << " is quitting: " << quit_msg << std::endl;
+	std::string quit_msg = msg.isTrailingEmpty() ? "Client Quit" : msg.getTrailing();
+	LOG(COMMAND, INFO) << "Client " << client->getClientFd() << " is quitting: " << quit_msg;
 
 	if (!client->getNickname().empty())
 	{
-		std::map<std::string, Channel *> &channels = server->getChannels();
-		for (std::map<std::string, Channel *>::iterator it = channels.begin(); it != channels.end(); ++it)
-		{
-			Channel *channel = it->second;
-			if (channel && channel->isUserInChannel(client->getClientFd()))
-			{
-				channel->broadcast(IRCResponse::createQUIT(client->getNickname(), client->getUsername(),
-					server->getHostname(), quit_msg), server, -1);
-			}
-		}
+		server->broadcastToPeers(client, IRCResponse::createQUIT(client->getPrefix(), quit_msg), false);
 	}
 	server->removeClient(client->getClientFd());
 }
 
-bool CommandExecuter::validateBasicCommand(Server *server, Client *client, const IRCMessage &msg, const std::string &commandName)
-{
-	if (!client->isRegistered())
-	{
-		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorNotRegistered(client->getNickname()));
-		return false;
-	}
-
-	if (msg.getParams().empty())
-	{
-		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorNeedMoreParams(client->getNickname(), commandName));
-		return false;
-	}
-
-	return true;
-}
-
 void CommandExecuter::handlePRIVMSG(Server *server, Client *client, const IRCMessage &msg)
 {
-	if (!client->isRegistered())
-	{
-		client->writeAndEnablePollOut(server,
-			IRCResponse::createErrorNotRegistered(client->getNickname()));
-		return;
-	}
-
-	if (msg.getParams().empty() || msg.getTrailing().empty())
+	if (msg.isTrailingEmpty())
 	{
 		client->writeAndEnablePollOut(server,
 			IRCResponse::createErrorNeedMoreParams(client->getNickname(), "PRIVMSG"));
 		return;
 	}
 
-	std::string target = msg.getParams()[0];
+	std::string target = msg.getParam(0);
 	std::string message = msg.getTrailing();
 
-	std::string privmsgFormat = IRCResponse::createPrivmsg(client->getNickname(), client->getUsername(), server->getHostname(), target, message);
+	ReplyBuffer privmsgFormat = IRCResponse::createPrivmsg(client->getPrefix(), target, message);
 
-	if (target[0] == '#')
+	if (!target.empty() && target[0] == '#')
 	{
 		Channel *channel = server->getChannel(target);
 		if (!channel)
@@ -298,7 +275,7 @@ void CommandExecuter::handlePRIVMSG(Server *server, Client *client, const IRCMes
 			return;
 		}
 
-		channel->broadcast(privmsgFormat, server, client->getClientFd());
+		channel->broadcast(privmsgFormat, server, client->getClientFd(), false);
 	}
 	else
 	{
@@ -310,6 +287,131 @@ void CommandExecuter::handlePRIVMSG(Server *server, Client *client, const IRCMes
 			return;
 		}
 
-		targetClient->writeAndEnablePollOut(server, privmsgFormat);
+		targetClient->writeAndEnablePollOut(server, privmsgFormat, false);
 	}
 }
+
+// Shards keep their own pools, so their counts (and peaks) are summed in
+void CommandExecuter::sendPoolStats(Server *server, Client *client, const Pool &(Server::*getPool)() const)
+{
+	const std::vector<Server *> &shards = server->getShards();
+	const Pool &pool = (server->*getPool)();
+	std::string name = pool.getName();
+	Pool::Stats stats = pool.snapshot();
+	unsigned long used = stats.used;
+	unsigned long capacity = stats.capacity;
+	std::vector<unsigned long> shardPeaks;
+
+	// Each shard peaks at its own moment, so peaks are reported per pool
+	// rather than summed into a figure no pool ever reached
+	for (size_t i = 0; i < shards.size(); ++i)
+	{
+		Pool::Stats counts = (shards[i]->*getPool)().snapshot();
+		used += counts.used;
+		capacity += counts.capacity;
+		shardPeaks.push_back(counts.highWater);
+	}
+	client->writeAndEnablePollOut(server,
+		IRCResponse::createStatsCounter(client->getNickname(), name + "-pool-used", used));
+	client->writeAndEnablePollOut(server,
+		IRCResponse::createStatsCounter(client->getNickname(), name + "-pool-peak", stats.highWater));
+	for (size_t i = 0; i < shardPeaks.size(); ++i)
+	{
+		std::ostringstream label;
+		label << name << "-pool-peak-shard" << i;
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), label.str(), shardPeaks[i]));
+	}
+	client->writeAndEnablePollOut(server,
+		IRCResponse::createStatsCounter(client->getNickname(), name + "-pool-capacity", capacity));
+}
+
+void CommandExecuter::handleSTATS(Server *server, Client *client, const IRCMessage &msg)
+{
+	std::string query = msg.paramCount() > 0 ? msg.getParam(0) : "";
+	char letter = query.empty() ? '*' : query[0];
+
+	if (letter == 'm')
+	{
+		for (size_t id = CMD_UNKNOWN + 1; id < CMD_COUNT; ++id)
+		{
+			const CommandEntry &entry = commandTable[id];
+			if (entry.calls > 0)
+				client->writeAndEnablePollOut(server,
+					IRCResponse::createStatsCommands(client->getNickname(), entry.name, entry.calls));
+		}
+	}
+	else if (letter == 't')
+	{
+		Server::Stats stats = server->getStats().snapshot();
+		const std::vector<Worker *> &workers = server->getWorkers();
+		const std::vector<Server *> &shards = server->getShards();
+		unsigned long sendqDropped = stats.sendqDropped;
+		unsigned long sendqExceeded = stats.sendqExceeded;
+		unsigned long floodDeferred = stats.floodDeferred;
+		unsigned long floodExcess = stats.floodExcess;
+		unsigned long readBudgetHits = 0;
+		unsigned long commandBudgetHits = 0;
+		unsigned long acceptRejected = 0;
+		unsigned long acceptThrottled = 0;
+		for (size_t i = 0; i < workers.size(); ++i)
+		{
+			Worker::Stats counts = workers[i]->getStats().snapshot();
+			readBudgetHits += counts.readBudgetHits;
+			commandBudgetHits += counts.commandBudgetHits;
+			acceptRejected += counts.acceptRejected;
+			acceptThrottled += counts.acceptThrottled;
+		}
+		for (size_t i = 0; i < shards.size(); ++i)
+		{
+			Server::Stats counts = shards[i]->getStats().snapshot();
+			sendqDropped += counts.sendqDropped;
+			sendqExceeded += counts.sendqExceeded;
+		}
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "sendq-dropped", sendqDropped));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "sendq-exceeded", sendqExceeded));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "read-budget", server->getReadBudget()));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "read-budget-hits", readBudgetHits));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "command-budget", server->getCommandBudget()));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "command-budget-hits", commandBudgetHits));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "accept-rejected", acceptRejected));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "accept-throttled", acceptThrottled));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "throttle-hosts", server->getThrottle().size()));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "flood-burst", server->getFloodBurst() / 1000));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "flood-deferred", floodDeferred));
+		client->writeAndEnablePollOut(server,
+			IRCResponse::createStatsCounter(client->getNickname(), "flood-excess", floodExcess));
+	}
+	else if (letter == 'z')
+	{
+		sendPoolStats(server, client, &Server::getClientPool);
+		sendPoolStats(server, client, &Server::getChannelPool);
+		sendPoolStats(server, client, &Server::getMembershipPool);
+	}
+	else if (letter == 'f')
+	{
+		std::map<int, Client *> &clients = server->getClients();
+		for (std::map<int, Client *>::iterator it = clients.begin(); it != clients.end(); ++it)
+		{
+			if (it->second->getFloodPenalties() > 0)
+				client->writeAndEnablePollOut(server,
+					IRCResponse::createStatsCounter(client->getNickname(),
+						"flood " + (it->second->getNickname().empty() ? std::string("*") : it->second->getNickname()),
+						it->second->getFloodPenalties()));
+		}
+	}
+
+	client->writeAndEnablePollOut(server,
+		IRCResponse::createEndOfStats(client->getNickname(), letter));
+}
@@ -12,102 +12,105 @@
 
 #include "../includes/CommandParser.hpp"
 
-IRCMessage CommandParser::parseMessage(const std::string &message)
+bool CommandParser::parse(const char *line, size_t length, RawMessage &out)
 {
-	IRCMessage msg;
-	std::string line = trim(message);
-	size_t pos = 0;
+	IRCMessage::reset(out);
 
-	if (line.empty())
-	{
-		std::cout << "Warning: Empty IRC message received" << std::endl;
-		return msg;
-	}
-
-	if (line.length() > 510)
-	{
-		std::cout << "Warning: IRC message too long, truncating" << std::endl;
-		line = line.substr(0, 510);
-	}
+	// The line buffer already holds lines to max_line_length
+	const char *pos = line;
+	const char *end = line + length;
 
-	size_t trailing_pos = line.find(" :", pos);
-	std::string params_part;
+	while (pos < end && *pos == ' ')
+		++pos;
 
-	if (trailing_pos != std::string::npos)
+	// IRCv3 message tags are kept aside; no command looks at them yet
+	if (pos < end && *pos == '@')
 	{
-		params_part = line.substr(pos, trailing_pos - pos);
-		std::string trailing = line.substr(trailing_pos + 2);
-		msg.setTrailing(trailing);
+		const char *start = ++pos;
+		while (pos < end && *pos != ' ')
+			++pos;
+		out.tags.data = start;
+		out.tags.length = pos - start;
+		while (pos < end && *pos == ' ')
+			++pos;
 	}
-	else
+	if (pos == end)
 	{
-		params_part = line.substr(pos);
+		LOG(COMMAND, DEBUG) << "Empty IRC message received";
+		return false;
 	}
 
-	std::vector<std::string> tokens = splitString(params_part, ' ');
-	if (!tokens.empty())
+	if (*pos == ':')
 	{
-		std::string command = tokens[0];
+		const char *start = ++pos;
+		while (pos < end && *pos != ' ')
+			++pos;
+		out.prefix.data = start;
+		out.prefix.length = pos - start;
+		while (pos < end && *pos == ' ')
+			++pos;
+	}
 
-		if (isValidCommand(command))
-		{
-			msg.setCommand(command);
+	const char *start = pos;
+	while (pos < end && *pos != ' ')
+		++pos;
+	out.command.data = start;
+	out.command.length = pos - start;
 
-			for (size_t i = 1; i < tokens.size() && i <= 15; ++i)
-			{
-				msg.addParam(tokens[i]);
-			}
-		}
-		else
-		{
-			std::cout << "Warning: Invalid IRC command: " << command << std::endl;
-		}
-	}
-	else
+	if (!isValidCommand(out.command))
 	{
-		std::cout << "Warning: No command found in IRC message" << std::endl;
+		if (out.command.length == 0)
+			LOG(COMMAND, DEBUG) << "No command found in IRC message";
+		else
+			LOG(COMMAND, DEBUG) << "Invalid IRC command: " << std::string(start, pos - start);
+		out.command.length = 0;
+		return false;
 	}
+	out.commandId = resolveCommand(out.command);
 
-	return msg;
-}
+	while (pos < end)
+	{
+		while (pos < end && *pos == ' ')
+			++pos;
+		if (pos == end)
+			break;
 
-std::vector<std::string> CommandParser::splitString(const std::string &str, char delimiter)
-{
-	std::vector<std::string> tokens;
-	std::stringstream ss(str);
-	std::string token;
+		if (*pos == ':' || out.paramCount == RawMessage::MAX_MIDDLE_PARAMS)
+		{
+			if (*pos == ':')
+				++pos;
+			out.trailing.data = pos;
+			out.trailing.length = end - pos;
+			out.hasTrailing = true;
+			break;
+		}
 
-	while (std::getline(ss, token, delimiter))
-	{
-		token = trim(token);
-		if (!token.empty())
-			tokens.push_back(token);
+		start = pos;
+		while (pos < end && *pos != ' ')
+			++pos;
+		out.params[out.paramCount].data = start;
+		out.params[out.paramCount].length = pos - start;
+		++out.paramCount;
 	}
 
-	return tokens;
+	return true;
 }
 
-std::string CommandParser::trim(const std::string &str)
+IRCMessage CommandParser::parseMessage(const char *line, size_t length)
 {
-	if (str.empty())
-		return str;
-
-	size_t start = str.find_first_not_of(" \t\r\n");
-	if (start == std::string::npos)
-		return "";
-
-	size_t end = str.find_last_not_of(" \t\r\n");
-	return str.substr(start, end - start + 1);
+	RawMessage raw;
+	parse(line, length, raw);
+	return IRCMessage(raw);
 }
 
-bool CommandParser::isValidCommand(const std::string &command)
+bool CommandParser::isValidCommand(const StringView &command)
 {
-	if (command.empty())
+	if (command.length == 0)
 		return false;
 
-	for (size_t i = 0; i < command.length(); ++i)
+	for (size_t i = 0; i < command.length; ++i)
 	{
-		char c = command[i];
+		char c = command.data[i];
 		if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') ||
 			  (c >= '0' && c <= '9')))
 		{
@@ -117,3 +120,69 @@ bool CommandParser::isValidCommand(const std::string &command)
 
 	return true;
 }
+
+bool CommandParser::matches(const StringView &command, const char *name)
+{
+	for (size_t i = 0; i < command.length; ++i)
+	{
+		char c = command.data[i];
+		if (c >= 'a' && c <= 'z')
+			c -= 'a' - 'A';
+		if (c != name[i])
+			return false;
+	}
+	return true;
+}
+
+CommandId CommandParser::resolveCommand(const StringView &command)
+{
+	char first = command.data[0];
+	if (first >= 'a' && first <= 'z')
+		first -= 'a' - 'A';
+
+	switch (command.length)
+	{
+	case 4:
+		switch (first)
+		{
+		case 'J':
+			return matches(command, "JOIN") ? CMD_JOIN : CMD_UNKNOWN;
+		case 'K':
+			return matches(command, "KICK") ? CMD_KICK : CMD_UNKNOWN;
+		case 'M':
+			return matches(command, "MODE") ? CMD_MODE : CMD_UNKNOWN;
+		case 'N':
+			return matches(command, "NICK") ? CMD_NICK : CMD_UNKNOWN;
+		case 'P':
+			if (matches(command, "PING"))
+				return CMD_PING;
+			if (matches(command, "PONG"))
+				return CMD_PONG;
+			if (matches(command, "PART"))
+				return CMD_PART;
+			if (matches(command, "PASS"))
+				return CMD_PASS;
+			return CMD_UNKNOWN;
+		case 'Q':
+			return matches(command, "QUIT") ? CMD_QUIT : CMD_UNKNOWN;
+		case 'U':
+			return matches(command, "USER") ? CMD_USER : CMD_UNKNOWN;
+		}
+		break;
+	case 5:
+		if (first == 'T')
+			return matches(command, "TOPIC") ? CMD_TOPIC : CMD_UNKNOWN;
+		if (first == 'S')
+			return matches(command, "STATS") ? CMD_STATS : CMD_UNKNOWN;
+		break;
+	case 6:
+		if (first == 'I')
+			return matches(command, "INVITE") ? CMD_INVITE : CMD_UNKNOWN;
+		break;
+	case 7:
+		if (first == 'P')
+			return matches(command, "PRIVMSG") ? CMD_PRIVMSG : CMD_UNKNOWN;
+		break;
+	}
+	return CMD_UNKNOWN;
+}
@@ -0,0 +1,148 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Config.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/20 14:02:11 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/20 14:02:11 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/Config.hpp"
+
+Config::Config()
+{
+}
+
+Config::Config(const Config &other) : _values(other._values)
+{
+}
+
+Config &Config::operator=(const Config &other)
+{
+	if (this != &other)
+		_values = other._values;
+	return *this;
+}
+
+Config::~Config()
+{
+}
+
+void Config::loadFile(const std::string &path)
+{
+	std::ifstream file(path.c_str());
+	if (!file.is_open())
+		throw ConfigFileUnreadable();
+
+	std::string line;
+	size_t lineNumber = 0;
+	while (std::getline(file, line))
+	{
+		++lineNumber;
+		parseLine(line, lineNumber);
+	}
+}
+
+void Config::parseLine(const std::string &line, size_t lineNumber)
+{
+	std::string content = line;
+	size_t comment = content.find('#');
+	if (comment != std::string::npos)
+		content.erase(comment);
+
+	content = trim(content);
+	if (content.empty())
+		return;
+
+	size_t eq = content.find('=');
+	if (eq == std::string::npos)
+	{
+		std::cerr << "Config line " << lineNumber << ": expected key = value" << std::endl;
+		throw InvalidConfigLine();
+	}
+
+	std::string key = trim(content.substr(0, eq));
+	std::string value = trim(content.substr(eq + 1));
+	if (key.empty())
+	{
+		std::cerr << "Config line " << lineNumber << ": missing key" << std::endl;
+		throw InvalidConfigLine();
+	}
+	_values[key] = value;
+}
+
+std::string Config::trim(const std::string &str)
+{
+	size_t start = str.find_first_not_of(" \t\r\n");
+	if (start == std::string::npos)
+		return "";
+
+	size_t end = str.find_last_not_of(" \t\r\n");
+	return str.substr(start, end - start + 1);
+}
+
+void Config::set(const std::string &key, const std::string &value)
+{
+	_values[key] = value;
+}
+
+bool Config::has(const std::string &key) const
+{
+	return _values.find(key) != _values.end();
+}
+
+std::string Config::getString(const std::string &key, const std::string &fallback) const
+{
+	std::map<std::string, std::string>::const_iterator it = _values.find(key);
+	if (it == _values.end())
+		return fallback;
+	return it->second;
+}
+
+long Config::getNumber(const std::string &key, long fallback) const
+{
+	std::map<std::string, std::string>::const_iterator it = _values.find(key);
+	if (it == _values.end())
+		return fallback;
+
+	const std::string &value = it->second;
+	if (value.empty())
+		throw InvalidConfigValue();
+	for (size_t i = 0; i < value.length(); ++i)
+	{
+		if (!std::isdigit(value[i]))
+		{
+			std::cerr << "Config key " << key << ": expected a number, got " << value << std::endl;
+			throw InvalidConfigValue();
+		}
+	}
+
+	// Only digits got this far, so a failed extraction means the value
+	// does not fit in a long
+	std::stringstream ss(value);
+	long number = 0;
+	if (!(ss >> number) || !ss.eof())
+	{
+		std::cerr << "Config key " << key << ": number out of range: " << value << std::endl;
+		throw InvalidConfigValue();
+	}
+	return number;
+}
+
+const char *Config::ConfigFileUnreadable::what() const throw()
+{
+	return "Config file could not be opened.";
+}
+
+const char *Config::InvalidConfigLine::what() const throw()
+{
+	return "Invalid line in config file.";
+}
+
+const char *Config::InvalidConfigValue::what() const throw()
+{
+	return "Invalid value in config file.";
+}
@@ -0,0 +1,141 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Connection.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/29 14:37:21 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/29 14:37:21 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/Connection.hpp"
+
+Connection::Backlog::Backlog() : _bytes(0), _refs(1)
+{
+}
+
+Connection::Backlog *Connection::Backlog::create()
+{
+	return new Backlog();
+}
+
+void Connection::Backlog::retain()
+{
+	__sync_add_and_fetch(&_refs, 1);
+}
+
+void Connection::Backlog::release()
+{
+	if (__sync_sub_and_fetch(&_refs, 1) == 0)
+		delete this;
+}
+
+void Connection::Backlog::add(long bytes)
+{
+	__sync_add_and_fetch(&_bytes, bytes);
+}
+
+size_t Connection::Backlog::get()
+{
+	return __sync_add_and_fetch(&_bytes, 0);
+}
+
+Connection::Connection(int fd, int id) : _fd(fd), _id(id), _backlog(NULL),
+	_readReady(false), _dirty(false), _closing(false)
+{
+	std::memset(&_address, 0, sizeof(_address));
+}
+
+Connection::~Connection()
+{
+	if (_backlog)
+		_backlog->release();
+}
+
+int Connection::getFd() const
+{
+	return _fd;
+}
+
+int Connection::getId() const
+{
+	return _id;
+}
+
+LineBuffer& Connection::getReadBuffer()
+{
+	return _readBuffer;
+}
+
+SendQueue& Connection::getSendQueue()
+{
+	return _sendQueue;
+}
+
+Connection::Backlog* Connection::getBacklog() const
+{
+	return _backlog;
+}
+
+const Throttle::Address& Connection::getAddress() const
+{
+	return _address;
+}
+
+// What the client still has to receive, wherever it is queued
+size_t Connection::pendingBytes() const
+{
+	return _sendQueue.size() + (_backlog ? _backlog->get() : 0);
+}
+
+bool Connection::isReadReady() const
+{
+	return _readReady;
+}
+
+bool Connection::isDirty() const
+{
+	return _dirty;
+}
+
+bool Connection::isClosing() const
+{
+	return _closing;
+}
+
+const std::string& Connection::getCloseReason() const
+{
+	return _closeReason;
+}
+
+void Connection::setBacklog(Backlog* backlog)
+{
+	if (_backlog)
+		_backlog->release();
+	_backlog = backlog;
+	if (_backlog)
+		_backlog->retain();
+}
+
+void Connection::setAddress(const Throttle::Address& address)
+{
+	_address = address;
+}
+
+void Connection::setReadReady(bool ready)
+{
+	_readReady = ready;
+}
+
+void Connection::setDirty(bool dirty)
+{
+	_dirty = dirty;
+}
+
+void Connection::markClosing(const std::string& reason)
+{
+	_closing = true;
+	_closeReason = reason;
+}
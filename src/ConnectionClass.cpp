@@ -0,0 +1,47 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ConnectionClass.cpp                                :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/28 10:12:44 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/28 10:12:44 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/ConnectionClass.hpp"
+
+ConnectionClass::ConnectionClass(const std::string &name, size_t sendqSoft, size_t sendqHard)
+	: _name(name), _sendqSoft(sendqSoft), _sendqHard(sendqHard)
+{
+}
+
+void ConnectionClass::load(const Config &config)
+{
+	_sendqSoft = config.getNumber(_name + "_sendq_soft", _sendqSoft);
+	_sendqHard = config.getNumber(_name + "_sendq_hard", _sendqHard);
+
+	if (_sendqSoft > _sendqHard)
+		throw InvalidLimits();
+}
+
+const std::string &ConnectionClass::getName() const
+{
+	return _name;
+}
+
+size_t ConnectionClass::getSendqSoft() const
+{
+	return _sendqSoft;
+}
+
+size_t ConnectionClass::getSendqHard() const
+{
+	return _sendqHard;
+}
+
+const char *ConnectionClass::InvalidLimits::what() const throw()
+{
+	return "Connection class soft sendq limit is above its hard limit";
+}
@@ -12,53 +12,91 @@
 
 #include "../includes/IRCMessage.hpp"
 
-IRCMessage::IRCMessage() : command(""), params(), trailing("") {}
+IRCMessage::IRCMessage()
+{
+	reset(raw);
+}
+
+IRCMessage::IRCMessage(const RawMessage &raw) : raw(raw)
+{
+}
 
 IRCMessage::~IRCMessage()
 {
 }
 
-IRCMessage::IRCMessage(const IRCMessage &other)
+IRCMessage::IRCMessage(const IRCMessage &other) : raw(other.raw)
 {
-	this->command = other.command;
-	this->params = other.params;
-	this->trailing = other.trailing;
 }
 
 IRCMessage &IRCMessage::operator=(const IRCMessage &other)
 {
 	if (this != &other)
 	{
-		this->command = other.command;
-		this->params = other.params;
-		this->trailing = other.trailing;
+		this->raw = other.raw;
 	}
 	return *this;
 }
 
-const std::string &IRCMessage::getCommand() const {
-	return command;
+void IRCMessage::reset(RawMessage &raw)
+{
+	raw.prefix.data = "";
+	raw.prefix.length = 0;
+	raw.tags = raw.prefix;
+	raw.command = raw.prefix;
+	raw.commandId = CMD_UNKNOWN;
+	raw.trailing = raw.prefix;
+	raw.paramCount = 0;
+	raw.hasTrailing = false;
 }
 
-const std::string &IRCMessage::getTrailing() const {
-	return trailing;
+std::string IRCMessage::toString(const StringView &view)
+{
+	return std::string(view.data, view.length);
 }
 
-const std::vector<std::string> &IRCMessage::getParams() const {
-	return params;
+const RawMessage &IRCMessage::getRaw() const {
+	return raw;
 }
 
-void IRCMessage::setCommand(const std::string &command)
-{
-	this->command = command;
+std::string IRCMessage::getPrefix() const {
+	return toString(raw.prefix);
 }
 
-void IRCMessage::setTrailing(const std::string &trailing)
-{
-	this->trailing = trailing;
+std::string IRCMessage::getCommand() const {
+	return toString(raw.command);
 }
 
-void IRCMessage::addParam(const std::string &param)
-{
-	params.push_back(param);
+CommandId IRCMessage::getCommandId() const {
+	return raw.commandId;
+}
+
+std::string IRCMessage::getTrailing() const {
+	return toString(raw.trailing);
+}
+
+bool IRCMessage::hasTrailing() const {
+	return raw.hasTrailing;
+}
+
+bool IRCMessage::isTrailingEmpty() const {
+	return raw.trailing.length == 0;
+}
+
+size_t IRCMessage::paramCount() const {
+	return raw.paramCount;
+}
+
+std::string IRCMessage::getParam(size_t index) const {
+	if (index >= raw.paramCount)
+		return std::string();
+	return toString(raw.params[index]);
+}
+
+std::vector<std::string> IRCMessage::getParams() const {
+	std::vector<std::string> params;
+	params.reserve(raw.paramCount);
+	for (size_t i = 0; i < raw.paramCount; ++i)
+		params.push_back(toString(raw.params[i]));
+	return params;
 }
@@ -12,314 +12,350 @@
 
 #include "../includes/IRCResponse.hpp"
 
-std::string IRCResponse::createErrorNeedMoreParams(const std::string &nick, const std::string &command)
+ReplyBuffer IRCResponse::createErrorInputTooLong(const std::string &nick)
 {
-	std::ostringstream oss;
-	oss << ":server 461 " << nick << " " << command << " :Not enough parameters\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 417 " << nick << " :Input line was too long";
+	return reply;
 }
 
-std::string IRCResponse::createErrorNoNicknameGiven(const std::string &nick)
+ReplyBuffer IRCResponse::createErrorNeedMoreParams(const std::string &nick, const std::string &command)
 {
-	std::ostringstream oss;
-	oss << ":server 431 " << nick << " :No nickname given\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 461 " << nick << " " << command << " :Not enough parameters";
+	return reply;
 }
 
-std::string IRCResponse::createErrorErroneusNickname(const std::string &nick, const std::string &badNick)
+ReplyBuffer IRCResponse::createErrorNoNicknameGiven(const std::string &nick)
 {
-	std::ostringstream oss;
-	oss << ":server 432 " << nick << " " << badNick << " :Erroneus nickname\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 431 " << nick << " :No nickname given";
+	return reply;
 }
 
-std::string IRCResponse::createErrorNicknameInUse(const std::string &nick, const std::string &usedNick)
+ReplyBuffer IRCResponse::createErrorErroneusNickname(const std::string &nick, const std::string &badNick)
 {
-	std::ostringstream oss;
-	oss << ":server 433 " << nick << " " << usedNick << " :Nickname is already in use\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 432 " << nick << " " << badNick << " :Erroneus nickname";
+	return reply;
 }
 
-std::string IRCResponse::createErrorNotRegistered(const std::string &nick)
+ReplyBuffer IRCResponse::createErrorNicknameInUse(const std::string &nick, const std::string &usedNick)
 {
-	std::ostringstream oss;
-	oss << ":server 451 " << nick << " :You have not registered\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 433 " << nick << " " << usedNick << " :Nickname is already in use";
+	return reply;
 }
 
-std::string IRCResponse::createErrorUnknownCommand(const std::string &nick, const std::string &command)
+ReplyBuffer IRCResponse::createErrorNotRegistered(const std::string &nick)
 {
-	std::ostringstream oss;
-	oss << ":server 421 " << nick << " " << command << " :Unknown command\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 451 " << nick << " :You have not registered";
+	return reply;
 }
 
-std::string IRCResponse::createErrorAlreadyRegistered(const std::string &nick)
+ReplyBuffer IRCResponse::createErrorUnknownCommand(const std::string &nick, const std::string &command)
 {
-	std::ostringstream oss;
-	oss << ":server 462 " << nick << " :You may not reregister\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 421 " << nick << " " << command << " :Unknown command";
+	return reply;
 }
 
-std::string IRCResponse::createErrorPasswdMismatch(const std::string &nick)
+ReplyBuffer IRCResponse::createErrorAlreadyRegistered(const std::string &nick)
 {
-	std::ostringstream oss;
-	oss << ":server 464 " << nick << " :Password incorrect\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 462 " << nick << " :You may not reregister";
+	return reply;
 }
 
-std::string IRCResponse::createErrorNoSuchChannel(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorPasswdMismatch(const std::string &nick)
 {
-	std::ostringstream oss;
-	oss << ":server 403 " << nick << " " << channel << " :No such channel\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 464 " << nick << " :Password incorrect";
+	return reply;
 }
 
-std::string IRCResponse::createErrorNotOnChannel(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorNoSuchChannel(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 442 " << nick << " " << channel << " :You're not on that channel\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 403 " << nick << " " << channel << " :No such channel";
+	return reply;
 }
 
-std::string IRCResponse::createQUIT(const std::string &nick, const std::string &user, const std::string &host, const std::string &reason)
+ReplyBuffer IRCResponse::createErrorNotOnChannel(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":" << nick << "!" << user << "@" << host << " QUIT :" << reason << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 442 " << nick << " " << channel << " :You're not on that channel";
+	return reply;
 }
 
-std::string IRCResponse::createErrorNoSuchNick(const std::string &nick, const std::string &target)
+ReplyBuffer IRCResponse::createQUIT(const std::string &prefix, const std::string &reason)
 {
-	std::ostringstream oss;
-	oss << ":server 401 " << nick << " " << target << " :No such nick/channel\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << prefix << " QUIT :" << reason;
+	return reply;
 }
 
-std::string IRCResponse::createErrorCannotSendToChan(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorNoSuchNick(const std::string &nick, const std::string &target)
 {
-	std::ostringstream oss;
-	oss << ":server 404 " << nick << " " << channel << " :Cannot send to channel\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 401 " << nick << " " << target << " :No such nick/channel";
+	return reply;
 }
 
-std::string IRCResponse::createErrorChanOPrivsNeeded(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorCannotSendToChan(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 482 " << nick << " " << channel << " :You're not channel operator\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 404 " << nick << " " << channel << " :Cannot send to channel";
+	return reply;
 }
 
-std::string IRCResponse::createErrorUserNotInChannel(const std::string &nick, const std::string &target, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorChanOPrivsNeeded(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 441 " << nick << " " << target << " " << channel << " :They aren't on that channel\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 482 " << nick << " " << channel << " :You're not channel operator";
+	return reply;
 }
 
-std::string IRCResponse::createErrorUserOnChannel(const std::string &nick, const std::string &target, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorUserNotInChannel(const std::string &nick, const std::string &target, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 443 " << nick << " " << target << " " << channel << " :is already on channel\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 441 " << nick << " " << target << " " << channel << " :They aren't on that channel";
+	return reply;
 }
 
-std::string IRCResponse::createErrorInviteOnlyChannel(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorUserOnChannel(const std::string &nick, const std::string &target, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 473 " << nick << " " << channel << " :This channel is invite only\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 443 " << nick << " " << target << " " << channel << " :is already on channel";
+	return reply;
 }
 
-std::string IRCResponse::createErrorChannelIsFull(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorInviteOnlyChannel(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 471 " << nick << " " << channel << " :Cannot join channel (+l)\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 473 " << nick << " " << channel << " :This channel is invite only";
+	return reply;
 }
 
-std::string IRCResponse::createErrorTopicOPrivsNeeded(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorChannelIsFull(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 482 " << nick << " " << channel << " :You're not channel operator\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 471 " << nick << " " << channel << " :Cannot join channel (+l)";
+	return reply;
 }
 
-std::string IRCResponse::createErrorBadChannelKey(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorTopicOPrivsNeeded(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 475 " << nick << " " << channel << " :Cannot join channel (+k)\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 482 " << nick << " " << channel << " :You're not channel operator";
+	return reply;
 }
 
-std::string IRCResponse::createErrorUserOnChannel(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createErrorBadChannelKey(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 443 " << nick << " " << channel << " :is already on channel\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 475 " << nick << " " << channel << " :Cannot join channel (+k)";
+	return reply;
 }
 
-std::string IRCResponse::createWelcome(const std::string &nick, const std::string &user, const std::string &host)
+ReplyBuffer IRCResponse::createErrorUserOnChannel(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 001 " << nick << " :Welcome to the Internet Relay Network " << nick << "!" << user << "@" << host << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 443 " << nick << " " << channel << " :is already on channel";
+	return reply;
 }
 
-std::string IRCResponse::createYourHost(const std::string &nick, const std::string &serverName)
+ReplyBuffer IRCResponse::createWelcome(const std::string &nick, const std::string &user, const std::string &host)
 {
-	std::ostringstream oss;
-	oss << ":server 002 " << nick << " :Your host is " << serverName << ", running version 1.0\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 001 " << nick << " :Welcome to the Internet Relay Network " << nick << "!" << user << "@" << host;
+	return reply;
 }
 
-std::string IRCResponse::createCreated(const std::string &nick, const std::string &date)
+ReplyBuffer IRCResponse::createYourHost(const std::string &nick, const std::string &serverName)
 {
-	std::ostringstream oss;
-	oss << ":server 003 " << nick << " :This server was created " << date << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 002 " << nick << " :Your host is " << serverName << ", running version 1.0";
+	return reply;
 }
 
-std::string IRCResponse::createMyInfo(const std::string &nick, const std::string &serverName)
+ReplyBuffer IRCResponse::createCreated(const std::string &nick, const std::string &date)
 {
-	std::ostringstream oss;
-	oss << ":server 004 " << nick << " " << serverName << " 1.0 o itklo\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 003 " << nick << " :This server was created " << date;
+	return reply;
 }
 
-std::string IRCResponse::createISupport(const std::string &nick)
+ReplyBuffer IRCResponse::createMyInfo(const std::string &nick, const std::string &serverName)
 {
-	std::ostringstream oss;
-	oss << ":server 005 " << nick
+	ReplyBuffer reply;
+	reply << ":server 004 " << nick << " " << serverName << " 1.0 o itklo";
+	return reply;
+}
+
+ReplyBuffer IRCResponse::createISupport(const std::string &nick)
+{
+	ReplyBuffer reply;
+	reply << ":server 005 " << nick
 		<< " CHANTYPES=#"
 		<< " CHANMODES=,,,itklo"
 		<< " PREFIX=(o)@"
-		<< " :are supported by this server\r\n";
-	return oss.str();
+		<< " CASEMAPPING=rfc1459"
+		<< " :are supported by this server";
+	return reply;
+}
+
+ReplyBuffer IRCResponse::createPing(const std::string &serverName)
+{
+	ReplyBuffer reply;
+	reply << "PING :" << serverName;
+	return reply;
+}
+
+ReplyBuffer IRCResponse::createPong(const std::string &serverName, const std::string &token)
+{
+	ReplyBuffer reply;
+	reply << ":" << serverName << " PONG " << serverName << " :" << token;
+	return reply;
+}
+
+ReplyBuffer IRCResponse::createJoin(const std::string &prefix, const std::string &channel)
+{
+	ReplyBuffer reply;
+	reply << prefix << " JOIN " << channel;
+	return reply;
+}
+
+ReplyBuffer IRCResponse::createPart(const std::string &prefix, const std::string &channel)
+{
+	ReplyBuffer reply;
+	reply << prefix << " PART " << channel;
+	return reply;
 }
 
-std::string IRCResponse::createPong(const std::string &serverName, const std::string &token)
+ReplyBuffer IRCResponse::createKick(const std::string &prefix, const std::string &channel, const std::string &target, const std::string &reason)
 {
-	std::ostringstream oss;
-	oss << ":" << serverName << " PONG " << serverName << " :" << token << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << prefix << " KICK " << channel << " " << target << " :" << reason;
+	return reply;
 }
 
-std::string IRCResponse::createJoin(const std::string &nick, const std::string &user, const std::string &host, const std::string &channel)
+ReplyBuffer IRCResponse::createNamReply(const std::string &nick, const std::string &channel, const std::string &names)
 {
-	std::ostringstream oss;
-	oss << ":" << nick << "!" << user << "@" << host << " JOIN " << channel << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 353 " << nick << " = " << channel << " :" << names;
+	return reply;
 }
 
-std::string IRCResponse::createPart(const std::string &nick, const std::string &user, const std::string &host, const std::string &channel)
+ReplyBuffer IRCResponse::createEndOfNames(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":" << nick << "!" << user << "@" << host << " PART " << channel << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 366 " << nick << " " << channel << " :End of /NAMES list";
+	return reply;
 }
 
-std::string IRCResponse::createKick(const std::string &nick, const std::string &user, const std::string &host, const std::string &channel, const std::string &target, const std::string &reason)
+ReplyBuffer IRCResponse::createPartWithReason(const std::string &prefix, const std::string &channel, const std::string &reason)
 {
-	std::ostringstream oss;
-	oss << ":" << nick << "!" << user << "@" << host << " KICK " << channel << " " << target << " :" << reason << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << prefix << " PART " << channel << " :" << reason;
+	return reply;
 }
 
-std::string IRCResponse::createNamReply(const std::string &nick, const std::string &channel, const std::string &names)
+ReplyBuffer IRCResponse::createInvite(const std::string &prefix, const std::string &target, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 353 " << nick << " = " << channel << " :" << names << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << prefix << " INVITE " << target << " " << channel;
+	return reply;
 }
 
-std::string IRCResponse::createEndOfNames(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createInviting(const std::string &nick, const std::string &target, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 366 " << nick << " " << channel << " :End of /NAMES list\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 341 " << nick << " " << target << " " << channel;
+	return reply;
 }
 
-std::string IRCResponse::createPartWithReason(const std::string &nick, const std::string &user, const std::string &host, const std::string &channel, const std::string &reason)
+ReplyBuffer IRCResponse::createTopic(const std::string &prefix, const std::string &channel, const std::string &topic)
 {
-	std::ostringstream oss;
-	oss << ":" << nick << "!" << user << "@" << host << " PART " << channel << " :" << reason << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << prefix << " TOPIC " << channel << " :" << topic;
+	return reply;
 }
 
-std::string IRCResponse::createInvite(const std::string &nick, const std::string &user, const std::string &host, const std::string &target, const std::string &channel)
+ReplyBuffer IRCResponse::createTopicReply(const std::string &nick, const std::string &channel, const std::string &topic)
 {
-	std::ostringstream oss;
-	oss << ":" << nick << "!" << user << "@" << host << " INVITE " << target << " " << channel << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 332 " << nick << " " << channel << " :" << topic;
+	return reply;
 }
 
-std::string IRCResponse::createInviting(const std::string &nick, const std::string &target, const std::string &channel)
+ReplyBuffer IRCResponse::createNoTopicReply(const std::string &nick, const std::string &channel)
 {
-	std::ostringstream oss;
-	oss << ":server 341 " << nick << " " << target << " " << channel << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 331 " << nick << " " << channel << " :No topic is set";
+	return reply;
 }
 
-std::string IRCResponse::createTopic(const std::string &nick, const std::string &user, const std::string &host, const std::string &channel, const std::string &topic)
+ReplyBuffer IRCResponse::createNotice(const std::string &nick, const std::string &message)
 {
-	std::ostringstream oss;
-	oss << ":" << nick << "!" << user << "@" << host << " TOPIC " << channel << " :" << topic << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server NOTICE " << nick << " :" << message;
+	return reply;
 }
 
-std::string IRCResponse::createTopicReply(const std::string &nick, const std::string &channel, const std::string &topic)
+ReplyBuffer IRCResponse::createNickChange(const std::string &prefix, const std::string &newNick)
 {
-	std::ostringstream oss;
-	oss << ":server 332 " << nick << " " << channel << " :" << topic << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << prefix << " NICK " << newNick;
+	return reply;
 }
 
-std::string IRCResponse::createNoTopicReply(const std::string &nick, const std::string &channel)
+ReplyBuffer IRCResponse::createPrivmsg(const std::string &prefix, const std::string &target, const std::string &message)
 {
-	std::ostringstream oss;
-	oss << ":server 331 " << nick << " " << channel << " :No topic is set\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << prefix << " PRIVMSG " << target << " :" << message;
+	return reply;
 }
 
-std::string IRCResponse::createNotice(const std::string &nick, const std::string &message)
+ReplyBuffer IRCResponse::createModeReply(const std::string &nick, const std::string &channel, const std::string &modes)
 {
-	std::ostringstream oss;
-	oss << ":server NOTICE " << nick << " :" << message << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 324 " << nick << " " << channel << " " << modes;
+	return reply;
 }
 
-std::string IRCResponse::createNickChange(const std::string &oldNick, const std::string &user, const std::string &host, const std::string &newNick)
+ReplyBuffer IRCResponse::createUnknownModeFlag(const std::string &nick)
 {
-	std::ostringstream oss;
-	oss << ":" << oldNick << "!" << user << "@" << host << " NICK " << newNick << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 501 " << nick << " :Unknown MODE flag";
+	return reply;
 }
 
-std::string IRCResponse::createPrivmsg(const std::string &nick, const std::string &user, const std::string &host, const std::string &target, const std::string &message)
+ReplyBuffer IRCResponse::createModeChange(const std::string &prefix, const std::string &channel, const std::string &modes)
 {
-	std::ostringstream oss;
-	oss << ":" << nick << "!" << user << "@" << host << " PRIVMSG " << target << " :" << message << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << prefix << " MODE " << channel << " " << modes;
+	return reply;
 }
 
-std::string IRCResponse::createModeReply(const std::string &nick, const std::string &channel, const std::string &modes)
+ReplyBuffer IRCResponse::createStatsCommands(const std::string &nick, const std::string &command, unsigned long count)
 {
-	std::ostringstream oss;
-	oss << ":server 324 " << nick << " " << channel << " " << modes << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 212 " << nick << " " << command << " " << count;
+	return reply;
 }
 
-std::string IRCResponse::createUnknownModeFlag(const std::string &nick)
+ReplyBuffer IRCResponse::createStatsCounter(const std::string &nick, const std::string &label, unsigned long value)
 {
-	std::ostringstream oss;
-	oss << ":server 501 " << nick << " :Unknown MODE flag\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 249 " << nick << " :" << label << " " << value;
+	return reply;
 }
 
-std::string IRCResponse::createModeChange(const std::string &nick, const std::string &user, const std::string &host, const std::string &channel, const std::string &modes)
+ReplyBuffer IRCResponse::createEndOfStats(const std::string &nick, char letter)
 {
-	std::ostringstream oss;
-	oss << ":" << nick << "!" << user << "@" << host << " MODE " << channel << " " << modes << "\r\n";
-	return oss.str();
+	ReplyBuffer reply;
+	reply << ":server 219 " << nick << " " << letter << " :End of STATS report";
+	return reply;
 }
@@ -0,0 +1,179 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   LineBuffer.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/24 09:31:02 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/24 09:31:02 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/LineBuffer.hpp"
+
+LineBuffer::LineBuffer() : _data(NULL), _capacity(0), _head(0), _tail(0), _scanned(0),
+	_maxLine(0), _limit(0), _discarding(false)
+{
+	setMaxLine(MAX_LINE);
+}
+
+LineBuffer::~LineBuffer()
+{
+	delete[] _data;
+}
+
+void LineBuffer::grow()
+{
+	size_t capacity = _capacity ? _capacity * 2 : INITIAL_CAPACITY;
+	char *data = new char[capacity];
+	size_t used = _tail - _head;
+
+	for (size_t i = 0; i < used; ++i)
+		data[i] = _data[(_head + i) & (_capacity - 1)];
+
+	delete[] _data;
+	_data = data;
+	_capacity = capacity;
+	_scanned -= _head;
+	_tail = used;
+	_head = 0;
+}
+
+// The ring only has to hold one partial line next to what a single read
+// brings in, so it never grows past twice the line limit. Input that is
+// pushed in by the caller needs room for its own chunks as well.
+void LineBuffer::setMaxLine(size_t maxLine, size_t chunk)
+{
+	_maxLine = maxLine;
+	_limit = INITIAL_CAPACITY;
+	while (_limit < 2 * maxLine || _limit < maxLine + chunk)
+		_limit *= 2;
+}
+
+ssize_t LineBuffer::readFrom(int fd, size_t limit)
+{
+	if (_tail - _head == _capacity)
+	{
+		if (_capacity >= _limit)
+		{
+			errno = ENOBUFS;
+			return -1;
+		}
+		grow();
+	}
+
+	size_t mask = _capacity - 1;
+	size_t tailIndex = _tail & mask;
+	size_t free = _capacity - (_tail - _head);
+	if (free > limit)
+		free = limit;
+
+	struct iovec iov[2];
+	int count = 1;
+	iov[0].iov_base = _data + tailIndex;
+	if (tailIndex + free <= _capacity)
+		iov[0].iov_len = free;
+	else
+	{
+		iov[0].iov_len = _capacity - tailIndex;
+		iov[1].iov_base = _data;
+		iov[1].iov_len = free - iov[0].iov_len;
+		count = 2;
+	}
+
+	ssize_t bytes = readv(fd, iov, count);
+	if (bytes > 0)
+		_tail += bytes;
+	return bytes;
+}
+
+// For bytes that were already received elsewhere, as with io_uring. Only
+// as much as fits under the limit is taken; the caller keeps the rest and
+// offers it again once lines have been consumed.
+size_t LineBuffer::append(const char *data, size_t length)
+{
+	if (length > _limit - (_tail - _head))
+		length = _limit - (_tail - _head);
+	if (length == 0)
+		return 0;
+	while (_capacity - (_tail - _head) < length)
+		grow();
+
+	size_t tailIndex = _tail & (_capacity - 1);
+	size_t first = _capacity - tailIndex;
+	if (first > length)
+		first = length;
+	std::memcpy(_data + tailIndex, data, first);
+	std::memcpy(_data, data + first, length - first);
+	_tail += length;
+	return length;
+}
+
+LineBuffer::Frame LineBuffer::nextLine(const char *&line, size_t &length)
+{
+	size_t mask = _capacity - 1;
+
+	while (_scanned < _tail)
+	{
+		if (_data[_scanned & mask] != '\n')
+		{
+			++_scanned;
+			if (_discarding)
+				_head = _scanned;
+			else if (_scanned - _head >= _maxLine)
+			{
+				_discarding = true;
+				_head = _scanned;
+				return TOO_LONG;
+			}
+			continue;
+		}
+
+		if (_discarding)
+		{
+			_discarding = false;
+			_head = ++_scanned;
+			continue;
+		}
+
+		size_t end = _scanned;
+		if (end > _head && _data[(end - 1) & mask] == '\r')
+			--end;
+
+		length = end - _head;
+		size_t start = _head & mask;
+		if (start + length <= _capacity)
+			line = _data + start;
+		else
+		{
+			size_t first = _capacity - start;
+			_scratch.assign(_data + start, first);
+			_scratch.append(_data, length - first);
+			line = _scratch.data();
+		}
+
+		++_scanned;
+		_head = _scanned;
+		return LINE;
+	}
+	return NONE;
+}
+
+void LineBuffer::clear()
+{
+	_head = 0;
+	_tail = 0;
+	_scanned = 0;
+	_discarding = false;
+}
+
+size_t LineBuffer::size() const
+{
+	return _tail - _head;
+}
+
+bool LineBuffer::empty() const
+{
+	return _tail == _head;
+}
@@ -0,0 +1,260 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Logger.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/26 11:20:37 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/26 11:20:37 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/Logger.hpp"
+#include "../includes/Config.hpp"
+
+Logger::Level Logger::_thresholds[Logger::CATEGORY_COUNT] = { Logger::INFO, Logger::INFO, Logger::INFO };
+Logger::Slot Logger::_ring[Logger::RING_SIZE];
+volatile unsigned long Logger::_head = 0;
+unsigned long Logger::_tail = 0;
+volatile unsigned long Logger::_dropped = 0;
+volatile int Logger::_draining = 0;
+
+Logger::Record::Record(Category category, Level level) : _category(category), _level(level), _length(0)
+{
+}
+
+Logger::Record::~Record()
+{
+	Logger::push(_category, _level, _text, _length);
+}
+
+Logger::Record &Logger::Record::append(const char *data, size_t length)
+{
+	size_t room = LINE_SIZE - _length;
+	if (length > room)
+		length = room;
+
+	std::memcpy(_text + _length, data, length);
+	_length += length;
+	return *this;
+}
+
+Logger::Record &Logger::Record::operator<<(const char *str)
+{
+	return append(str, std::strlen(str));
+}
+
+Logger::Record &Logger::Record::operator<<(const std::string &str)
+{
+	return append(str.data(), str.length());
+}
+
+Logger::Record &Logger::Record::operator<<(char c)
+{
+	return append(&c, 1);
+}
+
+Logger::Record &Logger::Record::operator<<(unsigned long number)
+{
+	char digits[24];
+	size_t pos = sizeof(digits);
+
+	do
+	{
+		digits[--pos] = '0' + (number % 10);
+		number /= 10;
+	} while (number > 0);
+
+	return append(digits + pos, sizeof(digits) - pos);
+}
+
+Logger::Record &Logger::Record::operator<<(long number)
+{
+	if (number < 0)
+	{
+		*this << '-';
+		return *this << static_cast<unsigned long>(-(number + 1)) + 1;
+	}
+	return *this << static_cast<unsigned long>(number);
+}
+
+Logger::Record &Logger::Record::operator<<(unsigned int number)
+{
+	return *this << static_cast<unsigned long>(number);
+}
+
+Logger::Record &Logger::Record::operator<<(int number)
+{
+	return *this << static_cast<long>(number);
+}
+
+// Bounded multi-producer ring. A slot's sequence is 2 * lap while it is
+// free for that lap and 2 * lap + 1 once a record has been written to it,
+// so the zero-initialized ring starts out empty.
+void Logger::push(Category category, Level level, const char *text, size_t length)
+{
+	unsigned long pos = _head;
+	Slot *slot;
+
+	for (;;)
+	{
+		slot = &_ring[pos % RING_SIZE];
+		unsigned long free = 2 * (pos / RING_SIZE);
+		unsigned long sequence = slot->sequence;
+
+		if (sequence == free)
+		{
+			if (__sync_bool_compare_and_swap(&_head, pos, pos + 1))
+				break;
+		}
+		else if (sequence < free)
+		{
+			__sync_fetch_and_add(&_dropped, 1);
+			return;
+		}
+		pos = _head;
+	}
+
+	slot->category = category;
+	slot->level = level;
+	slot->length = length;
+	std::memcpy(slot->text, text, length);
+	__sync_synchronize();
+	slot->sequence = 2 * (pos / RING_SIZE) + 1;
+}
+
+void Logger::writeAll(const char *data, size_t length)
+{
+	while (length > 0)
+	{
+		ssize_t written = write(STDOUT_FILENO, data, length);
+		if (written <= 0)
+			return;
+		data += written;
+		length -= written;
+	}
+}
+
+void Logger::flush()
+{
+	if (__sync_lock_test_and_set(&_draining, 1))
+		return;
+
+	static char batch[16384];
+	size_t used = 0;
+
+	for (;;)
+	{
+		Slot &slot = _ring[_tail % RING_SIZE];
+		unsigned long lap = _tail / RING_SIZE;
+
+		if (slot.sequence != 2 * lap + 1)
+			break;
+		__sync_synchronize();
+
+		const char *level = levelName(slot.level);
+		const char *category = categoryName(slot.category);
+		size_t levelLength = std::strlen(level);
+		size_t categoryLength = std::strlen(category);
+		size_t needed = levelLength + categoryLength + slot.length + 6;
+
+		if (used + needed > sizeof(batch))
+		{
+			writeAll(batch, used);
+			used = 0;
+		}
+		batch[used++] = '[';
+		std::memcpy(batch + used, level, levelLength);
+		used += levelLength;
+		batch[used++] = ']';
+		batch[used++] = ' ';
+		std::memcpy(batch + used, category, categoryLength);
+		used += categoryLength;
+		batch[used++] = ':';
+		batch[used++] = ' ';
+		std::memcpy(batch + used, slot.text, slot.length);
+		used += slot.length;
+		batch[used++] = '\n';
+
+		__sync_synchronize();
+		slot.sequence = 2 * lap + 2;
+		++_tail;
+	}
+	writeAll(batch, used);
+
+	unsigned long dropped = __sync_lock_test_and_set(&_dropped, 0);
+	if (dropped > 0)
+		LOG(NET, WARN) << dropped << " log records dropped, ring was full";
+
+	__sync_lock_release(&_draining);
+}
+
+void Logger::setLevel(Category category, Level level)
+{
+	_thresholds[category] = level;
+}
+
+void Logger::configure(const Config &config)
+{
+	Level level = parseLevel(config.getString("log_level", "info"));
+
+	for (int i = 0; i < CATEGORY_COUNT; ++i)
+	{
+		Category category = static_cast<Category>(i);
+		std::string key = std::string("log_level_") + categoryName(category);
+		setLevel(category, config.has(key) ? parseLevel(config.getString(key, "")) : level);
+	}
+}
+
+Logger::Level Logger::parseLevel(const std::string &name)
+{
+	if (name == "debug")
+		return DEBUG;
+	if (name == "info")
+		return INFO;
+	if (name == "warn")
+		return WARN;
+	if (name == "error")
+		return ERROR;
+	if (name == "off")
+		return OFF;
+	throw UnknownLevel();
+}
+
+const char *Logger::levelName(Level level)
+{
+	switch (level)
+	{
+	case DEBUG:
+		return "DEBUG";
+	case INFO:
+		return "INFO";
+	case WARN:
+		return "WARN";
+	case ERROR:
+		return "ERROR";
+	default:
+		return "OFF";
+	}
+}
+
+const char *Logger::categoryName(Category category)
+{
+	switch (category)
+	{
+	case NET:
+		return "net";
+	case COMMAND:
+		return "command";
+	case CHANNEL:
+		return "channel";
+	default:
+		return "unknown";
+	}
+}
+
+const char *Logger::UnknownLevel::what() const throw()
+{
+	return "Unknown log level. Use debug, info, warn, error or off.";
+}
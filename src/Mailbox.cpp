@@ -0,0 +1,112 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Mailbox.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/29 15:02:48 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/29 15:02:48 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/Mailbox.hpp"
+
+Mailbox::Message::Message(Type type, int id) : type(type), id(id), worker(0), overlong(0),
+	backlog(NULL), request(0), next(NULL)
+{
+}
+
+Mailbox::Message::~Message()
+{
+	if (backlog)
+		backlog->release();
+	for (size_t i = 0; i < identities.size(); ++i)
+		identities[i].backlog->release();
+}
+
+// The message keeps each backlog alive until the receiver has adopted it
+void Mailbox::Message::attach(const Identity &identity)
+{
+	identities.push_back(identity);
+	identity.backlog->retain();
+}
+
+Mailbox::Mailbox() : _head(NULL)
+{
+	_eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_eventFd < 0)
+		throw MailboxFailed();
+}
+
+Mailbox::~Mailbox()
+{
+	Message *message = collect();
+	while (message)
+	{
+		Message *next = message->next;
+		delete message;
+		message = next;
+	}
+	close(_eventFd);
+}
+
+void Mailbox::post(Message *message)
+{
+	Message *head;
+
+	do
+	{
+		head = _head;
+		message->next = head;
+	} while (!__sync_bool_compare_and_swap(&_head, head, message));
+
+	if (head == NULL)
+		wake();
+}
+
+void Mailbox::wake()
+{
+	uint64_t one = 1;
+	ssize_t written = write(_eventFd, &one, sizeof(one));
+	(void)written;
+}
+
+// The eventfd is cleared before the stack is taken: a post that lands in
+// between finds the stack empty and wakes the consumer again.
+Mailbox::Message *Mailbox::collect()
+{
+	uint64_t count;
+	ssize_t bytes = read(_eventFd, &count, sizeof(count));
+	(void)bytes;
+
+	Message *message = __sync_lock_test_and_set(&_head, static_cast<Message *>(NULL));
+	Message *ordered = NULL;
+	while (message)
+	{
+		Message *next = message->next;
+		message->next = ordered;
+		ordered = message;
+		message = next;
+	}
+	return ordered;
+}
+
+int Mailbox::wait(int timeoutMs)
+{
+	pollfd pfd;
+	pfd.fd = _eventFd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	return poll(&pfd, 1, timeoutMs);
+}
+
+int Mailbox::getFd() const
+{
+	return _eventFd;
+}
+
+const char *Mailbox::MailboxFailed::what() const throw()
+{
+	return "Mailbox eventfd creation failed.";
+}
@@ -18,12 +18,9 @@
 
 void ModeHandler::handleMODE(Server *server, Client *client, const IRCMessage &msg)
 {
-	if (!CommandExecuter::validateBasicCommand(server, client, msg, "MODE"))
-		return;
-
-	std::string target = msg.getParams()[0];
+	std::string target = msg.getParam(0);
 
-	if (target[0] == '#')
+	if (!target.empty() && target[0] == '#')
 	{
 		Channel *channel = server->getChannel(target);
 		if (!channel)
@@ -40,19 +37,19 @@ void ModeHandler::handleMODE(Server *server, Client *client, const IRCMessage &m
 			return;
 		}
 
-		if (msg.getParams().size() == 1)
+		if (msg.paramCount() == 1)
 		{
 			std::string currentModes = getFullModeString(channel);
-			std::string modeReply = IRCResponse::createModeReply(client->getNickname(), target, currentModes);
+			ReplyBuffer modeReply = IRCResponse::createModeReply(client->getNickname(), target, currentModes);
 			client->writeAndEnablePollOut(server, modeReply);
 			return;
 		}
 
-		std::string modeString = msg.getParams()[1];
+		std::string modeString = msg.getParam(1);
 		std::vector<std::string> params;
-		for (size_t i = 2; i < msg.getParams().size(); ++i)
+		for (size_t i = 2; i < msg.paramCount(); ++i)
 		{
-			params.push_back(msg.getParams()[i]);
+			params.push_back(msg.getParam(i));
 		}
 
 		handleChannelMode(server, client, target, modeString, params);
@@ -194,7 +191,7 @@ void ModeHandler::handleChannelMode(Server *server, Client *client, std::string
 
 	if (!appliedModes.empty())
 	{
-		std::string modeMsg = IRCResponse::createModeChange(client->getNickname(), client->getUsername(), server->getHostname(), channelName, appliedModes + (!modeParams.empty() ? " " + modeParams : ""));
+		ReplyBuffer modeMsg = IRCResponse::createModeChange(client->getPrefix(), channelName, appliedModes + (!modeParams.empty() ? " " + modeParams : ""));
 		channel->broadcast(modeMsg, server, -1);
 	}
 }
@@ -0,0 +1,146 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   NickIndex.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/21 11:40:27 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/21 11:40:27 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/NickIndex.hpp"
+
+NickIndex::NickIndex() : _buckets(64, static_cast<Node *>(NULL)), _size(0)
+{
+}
+
+NickIndex::~NickIndex()
+{
+	for (size_t i = 0; i < _buckets.size(); ++i)
+	{
+		Node *node = _buckets[i];
+		while (node)
+		{
+			Node *next = node->next;
+			delete node;
+			node = next;
+		}
+	}
+}
+
+char NickIndex::foldChar(char c)
+{
+	if (c >= 'A' && c <= 'Z')
+		return c + ('a' - 'A');
+	if (c == '[')
+		return '{';
+	if (c == ']')
+		return '}';
+	if (c == '\\')
+		return '|';
+	if (c == '~')
+		return '^';
+	return c;
+}
+
+bool NickIndex::equals(const std::string &a, const std::string &b)
+{
+	if (a.length() != b.length())
+		return false;
+	for (size_t i = 0; i < a.length(); ++i)
+	{
+		if (foldChar(a[i]) != foldChar(b[i]))
+			return false;
+	}
+	return true;
+}
+
+uint32_t NickIndex::hash(const std::string &nick)
+{
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < nick.length(); ++i)
+	{
+		h ^= static_cast<unsigned char>(foldChar(nick[i]));
+		h *= 16777619u;
+	}
+	return h;
+}
+
+size_t NickIndex::bucketFor(const std::string &nick) const
+{
+	return hash(nick) & (_buckets.size() - 1);
+}
+
+void NickIndex::rehash(size_t bucketCount)
+{
+	std::vector<Node *> buckets(bucketCount, static_cast<Node *>(NULL));
+
+	for (size_t i = 0; i < _buckets.size(); ++i)
+	{
+		Node *node = _buckets[i];
+		while (node)
+		{
+			Node *next = node->next;
+			size_t index = hash(node->key) & (bucketCount - 1);
+			node->next = buckets[index];
+			buckets[index] = node;
+			node = next;
+		}
+	}
+	_buckets.swap(buckets);
+}
+
+Client *NickIndex::find(const std::string &nick) const
+{
+	for (Node *node = _buckets[bucketFor(nick)]; node; node = node->next)
+	{
+		if (equals(node->key, nick))
+			return node->client;
+	}
+	return NULL;
+}
+
+size_t NickIndex::size() const
+{
+	return _size;
+}
+
+bool NickIndex::insert(const std::string &nick, Client *client)
+{
+	size_t index = bucketFor(nick);
+	for (Node *node = _buckets[index]; node; node = node->next)
+	{
+		if (equals(node->key, nick))
+			return node->client == client;
+	}
+
+	Node *node = new Node;
+	node->key = nick;
+	node->client = client;
+	node->next = _buckets[index];
+	_buckets[index] = node;
+	++_size;
+
+	if (_size > _buckets.size())
+		rehash(_buckets.size() * 2);
+	return true;
+}
+
+void NickIndex::erase(const std::string &nick)
+{
+	Node **link = &_buckets[bucketFor(nick)];
+	while (*link)
+	{
+		if (equals((*link)->key, nick))
+		{
+			Node *node = *link;
+			*link = node->next;
+			delete node;
+			--_size;
+			return;
+		}
+		link = &(*link)->next;
+	}
+}
@@ -0,0 +1,107 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Pool.cpp                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/10/04 15:37:12 by soksak            #+#    #+#             */
+/*   Updated: 2025/10/04 15:37:12 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/Pool.hpp"
+
+// Rounded up so every block is aligned for any object placed in it
+static const size_t BLOCK_ALIGN = 16;
+static const size_t MIN_SLAB_BLOCKS = 16;
+
+// Atomic load of a counter the owning thread keeps updating
+static size_t load(const size_t &counter)
+{
+	return __sync_fetch_and_add(const_cast<size_t *>(&counter), 0);
+}
+
+Pool::Pool(const char *name, size_t blockSize, size_t preallocate)
+	: _name(name), _blockSize((blockSize + BLOCK_ALIGN - 1) & ~(BLOCK_ALIGN - 1)),
+	  _slabBlocks(preallocate < MIN_SLAB_BLOCKS ? MIN_SLAB_BLOCKS : preallocate),
+	  _free(NULL), _capacity(0), _used(0), _highWater(0)
+{
+	if (preallocate > 0)
+		grow();
+}
+
+Pool::~Pool()
+{
+	for (size_t i = 0; i < _slabs.size(); ++i)
+		::operator delete(_slabs[i]);
+}
+
+void Pool::grow()
+{
+	char *slab = static_cast<char *>(::operator new(_blockSize * _slabBlocks));
+	_slabs.push_back(slab);
+	// Threaded back to front so blocks are handed out in address order
+	for (size_t i = _slabBlocks; i > 0; --i)
+	{
+		Block *block = reinterpret_cast<Block *>(slab + (i - 1) * _blockSize);
+		block->next = _free;
+		_free = block;
+	}
+	__sync_fetch_and_add(&_capacity, _slabBlocks);
+}
+
+void *Pool::allocate()
+{
+	if (!_free)
+		grow();
+	Block *block = _free;
+	_free = block->next;
+	size_t used = __sync_add_and_fetch(&_used, 1);
+	// Only the owning thread writes, so raising by the difference is exact
+	if (used > _highWater)
+		__sync_fetch_and_add(&_highWater, used - _highWater);
+	return block;
+}
+
+void Pool::release(void *pointer)
+{
+	Block *block = static_cast<Block *>(pointer);
+	block->next = _free;
+	_free = block;
+	__sync_fetch_and_sub(&_used, 1);
+}
+
+const char *Pool::getName() const
+{
+	return _name;
+}
+
+size_t Pool::getBlockSize() const
+{
+	return _blockSize;
+}
+
+size_t Pool::getCapacity() const
+{
+	return _capacity;
+}
+
+size_t Pool::getUsed() const
+{
+	return _used;
+}
+
+size_t Pool::getHighWater() const
+{
+	return _highWater;
+}
+
+Pool::Stats Pool::snapshot() const
+{
+	Stats copy;
+	copy.capacity = load(_capacity);
+	copy.used = load(_used);
+	copy.highWater = load(_highWater);
+	return copy;
+}
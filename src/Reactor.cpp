@@ -0,0 +1,255 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Reactor.cpp                                        :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/20 14:02:11 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/20 14:02:11 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/Reactor.hpp"
+
+Reactor::Slot::Slot() : pollIndex(-1), connection(NULL), interest(0), used(false)
+{
+}
+
+Reactor::Reactor(Backend backend) : _backend(backend), _epollFd(-1), _count(0)
+{
+	if (_backend == IO_URING && !Ring::isSupported())
+	{
+		LOG(NET, WARN) << "io_uring unavailable, falling back to epoll";
+		_backend = EPOLL;
+	}
+	if (_backend == EPOLL || _backend == EPOLL_ET)
+	{
+		_epollFd = epoll_create(1024);
+		if (_epollFd < 0)
+		{
+			LOG(NET, WARN) << "epoll unavailable, falling back to poll";
+			_backend = POLL;
+		}
+		else
+			_epollEvents.resize(256);
+	}
+}
+
+Reactor::~Reactor()
+{
+	if (_epollFd >= 0)
+		close(_epollFd);
+}
+
+void Reactor::epollControl(int op, int fd, bool writable)
+{
+	epoll_event ev;
+	std::memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	if (writable)
+		ev.events |= EPOLLOUT;
+	if (_backend == EPOLL_ET)
+		ev.events |= EPOLLET;
+	ev.data.fd = fd;
+
+	if (epoll_ctl(_epollFd, op, fd, &ev) < 0)
+		throw ReactorControlFailed();
+}
+
+Reactor::Slot &Reactor::slotFor(int fd)
+{
+	if (static_cast<size_t>(fd) >= _slots.size())
+		_slots.resize(fd + 1);
+	return _slots[fd];
+}
+
+void Reactor::add(int fd, Connection *connection)
+{
+	Slot &slot = slotFor(fd);
+	int pollIndex = -1;
+
+	// The slot is only filled in once the backend has taken the fd, so a
+	// failed add leaves nothing behind for remove() to trip over
+	if (_backend == POLL)
+	{
+		pollfd pfd;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		pfd.revents = 0;
+		pollIndex = _pollFds.size();
+		_pollFds.push_back(pfd);
+	}
+	else if (_backend != IO_URING)
+		epollControl(EPOLL_CTL_ADD, fd, false);
+
+	slot.used = true;
+	slot.connection = connection;
+	slot.interest = POLLIN;
+	slot.pollIndex = pollIndex;
+	++_count;
+}
+
+void Reactor::setWritable(int fd, bool enabled)
+{
+	if (fd < 0 || static_cast<size_t>(fd) >= _slots.size() || !_slots[fd].used)
+		return;
+
+	Slot &slot = _slots[fd];
+	bool current = (slot.interest & POLLOUT) != 0;
+	if (current == enabled)
+		return;
+
+	if (enabled)
+		slot.interest |= POLLOUT;
+	else
+		slot.interest &= ~POLLOUT;
+
+	if (_backend == POLL)
+		_pollFds[slot.pollIndex].events = slot.interest;
+	else if (_backend != IO_URING)
+		epollControl(EPOLL_CTL_MOD, fd, enabled);
+}
+
+void Reactor::remove(int fd)
+{
+	if (fd < 0 || static_cast<size_t>(fd) >= _slots.size() || !_slots[fd].used)
+		return;
+
+	Slot &slot = _slots[fd];
+	if (_backend == POLL)
+	{
+		size_t index = slot.pollIndex;
+		size_t last = _pollFds.size() - 1;
+		if (index != last)
+		{
+			_pollFds[index] = _pollFds[last];
+			_slots[_pollFds[index].fd].pollIndex = index;
+		}
+		_pollFds.pop_back();
+	}
+	else if (_backend != IO_URING)
+		epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+
+	slot = Slot();
+	--_count;
+}
+
+Connection *Reactor::getConnection(int fd) const
+{
+	if (fd < 0 || static_cast<size_t>(fd) >= _slots.size())
+		return NULL;
+	return _slots[fd].connection;
+}
+
+int Reactor::wait(std::vector<Event> &ready, int timeoutMs)
+{
+	ready.clear();
+	if (_backend == POLL)
+		return waitPoll(ready, timeoutMs);
+	return waitEpoll(ready, timeoutMs);
+}
+
+int Reactor::waitPoll(std::vector<Event> &ready, int timeoutMs)
+{
+	int count = poll(&_pollFds[0], _pollFds.size(), timeoutMs);
+	if (count <= 0)
+		return count;
+
+	for (size_t i = 0; i < _pollFds.size() && ready.size() < static_cast<size_t>(count); ++i)
+	{
+		short revents = _pollFds[i].revents;
+		if (!revents)
+			continue;
+
+		Event ev;
+		ev.fd = _pollFds[i].fd;
+		ev.readable = (revents & (POLLIN | POLLHUP | POLLERR)) != 0;
+		ev.writable = (revents & POLLOUT) != 0;
+		ready.push_back(ev);
+	}
+	return count;
+}
+
+int Reactor::waitEpoll(std::vector<Event> &ready, int timeoutMs)
+{
+	int count = epoll_wait(_epollFd, &_epollEvents[0], _epollEvents.size(), timeoutMs);
+	if (count <= 0)
+		return count;
+
+	for (int i = 0; i < count; ++i)
+	{
+		uint32_t events = _epollEvents[i].events;
+
+		Event ev;
+		ev.fd = _epollEvents[i].data.fd;
+		ev.readable = (events & (EPOLLIN | EPOLLHUP | EPOLLERR | EPOLLRDHUP)) != 0;
+		ev.writable = (events & EPOLLOUT) != 0;
+		ready.push_back(ev);
+	}
+
+	if (static_cast<size_t>(count) == _epollEvents.size())
+		_epollEvents.resize(_epollEvents.size() * 2);
+	return count;
+}
+
+bool Reactor::isWritable(int fd) const
+{
+	if (fd < 0 || static_cast<size_t>(fd) >= _slots.size() || !_slots[fd].used)
+		return false;
+	return (_slots[fd].interest & POLLOUT) != 0;
+}
+
+Reactor::Backend Reactor::getBackend() const
+{
+	return _backend;
+}
+
+bool Reactor::isEdgeTriggered() const
+{
+	return _backend == EPOLL_ET;
+}
+
+size_t Reactor::size() const
+{
+	return _count;
+}
+
+Reactor::Backend Reactor::parseBackend(const std::string &name)
+{
+	if (name == "poll")
+		return POLL;
+	if (name == "epoll")
+		return EPOLL;
+	if (name == "epoll-et")
+		return EPOLL_ET;
+	if (name == "io_uring")
+		return IO_URING;
+	throw UnknownBackend();
+}
+
+const char *Reactor::backendName(Backend backend)
+{
+	switch (backend)
+	{
+	case POLL:
+		return "poll";
+	case EPOLL:
+		return "epoll";
+	case EPOLL_ET:
+		return "epoll-et";
+	case IO_URING:
+		return "io_uring";
+	}
+	return "unknown";
+}
+
+const char *Reactor::ReactorControlFailed::what() const throw()
+{
+	return "Event loop registration failed.";
+}
+
+const char *Reactor::UnknownBackend::what() const throw()
+{
+	return "Unknown I/O backend. Use poll, epoll, epoll-et or io_uring.";
+}
@@ -0,0 +1,100 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   ReplyBuffer.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/25 18:44:09 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/25 18:44:09 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/ReplyBuffer.hpp"
+
+ReplyBuffer::ReplyBuffer() : _length(0)
+{
+	terminate();
+}
+
+void ReplyBuffer::terminate()
+{
+	_data[_length] = '\r';
+	_data[_length + 1] = '\n';
+}
+
+ReplyBuffer &ReplyBuffer::append(const char *data, size_t length)
+{
+	size_t room = MAX_CONTENT - _length;
+	if (length > room)
+		length = room;
+
+	std::memcpy(_data + _length, data, length);
+	_length += length;
+	terminate();
+	return *this;
+}
+
+ReplyBuffer &ReplyBuffer::operator<<(const char *str)
+{
+	return append(str, std::strlen(str));
+}
+
+ReplyBuffer &ReplyBuffer::operator<<(const std::string &str)
+{
+	return append(str.data(), str.length());
+}
+
+ReplyBuffer &ReplyBuffer::operator<<(char c)
+{
+	return append(&c, 1);
+}
+
+ReplyBuffer &ReplyBuffer::operator<<(unsigned long number)
+{
+	char digits[24];
+	size_t pos = sizeof(digits);
+
+	do
+	{
+		digits[--pos] = '0' + (number % 10);
+		number /= 10;
+	} while (number > 0);
+
+	return append(digits + pos, sizeof(digits) - pos);
+}
+
+ReplyBuffer &ReplyBuffer::operator<<(long number)
+{
+	if (number < 0)
+	{
+		*this << '-';
+		return *this << static_cast<unsigned long>(-(number + 1)) + 1;
+	}
+	return *this << static_cast<unsigned long>(number);
+}
+
+ReplyBuffer &ReplyBuffer::operator<<(unsigned int number)
+{
+	return *this << static_cast<unsigned long>(number);
+}
+
+ReplyBuffer &ReplyBuffer::operator<<(int number)
+{
+	return *this << static_cast<long>(number);
+}
+
+const char *ReplyBuffer::data() const
+{
+	return _data;
+}
+
+size_t ReplyBuffer::length() const
+{
+	return _length + 2;
+}
+
+std::string ReplyBuffer::str() const
+{
+	return std::string(_data, _length + 2);
+}
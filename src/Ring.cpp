@@ -0,0 +1,334 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Ring.cpp                                           :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/10/02 11:14:37 by soksak            #+#    #+#             */
+/*   Updated: 2025/10/02 11:14:37 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+
+#include "../includes/Ring.hpp"
+#include <vector>
+#include <poll.h>
+
+Ring::Ring(unsigned entries, unsigned bufferCount)
+	: _fd(-1), _map(MAP_FAILED), _mapSize(0),
+	  _sqes(static_cast<io_uring_sqe *>(MAP_FAILED)), _sqesSize(0),
+	  _sqHead(NULL), _sqTail(NULL), _sqMask(0), _sqEntries(0), _sqLocalTail(0),
+	  _cqHead(NULL), _cqTail(NULL), _cqMask(0), _cqes(NULL),
+	  _bufferRing(static_cast<io_uring_buf *>(MAP_FAILED)), _bufferRingSize(0),
+	  _buffers(NULL), _bufferCount(0)
+{
+	io_uring_params params;
+	std::memset(&params, 0, sizeof(params));
+	params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_COOP_TASKRUN;
+	params.cq_entries = entries * 8;
+
+	_fd = syscall(__NR_io_uring_setup, entries, &params);
+	if (_fd < 0)
+		throw RingUnavailable();
+
+	try
+	{
+		if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_NODROP)
+			|| !(params.features & IORING_FEAT_EXT_ARG))
+			throw RingUnavailable();
+
+		// Multishot receive came with 6.0, as did SEND_ZC; the probe only
+		// lists opcodes, so the latter stands in for the former.
+		static const int required[] = { IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SENDMSG,
+			IORING_OP_POLL_ADD, IORING_OP_ASYNC_CANCEL, IORING_OP_SEND_ZC };
+		std::vector<char> storage(sizeof(io_uring_probe) + IORING_OP_LAST * sizeof(io_uring_probe_op));
+		io_uring_probe *probe = reinterpret_cast<io_uring_probe *>(&storage[0]);
+		if (syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) < 0)
+			throw RingUnavailable();
+		for (size_t i = 0; i < sizeof(required) / sizeof(required[0]); ++i)
+			if (required[i] > probe->last_op || !(probe->ops[required[i]].flags & IO_URING_OP_SUPPORTED))
+				throw RingUnavailable();
+
+		_mapSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		if (cqSize > _mapSize)
+			_mapSize = cqSize;
+		_map = mmap(NULL, _mapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQ_RING);
+		if (_map == MAP_FAILED)
+			throw RingUnavailable();
+
+		_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		_sqes = static_cast<io_uring_sqe *>(mmap(NULL, _sqesSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, _fd, IORING_OFF_SQES));
+		if (_sqes == MAP_FAILED)
+			throw RingUnavailable();
+
+		char *sq = static_cast<char *>(_map);
+		_sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+		_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+		_sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+		_sqEntries = params.sq_entries;
+		_sqLocalTail = *_sqTail;
+		unsigned *array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+		for (unsigned i = 0; i < _sqEntries; ++i)
+			array[i] = i;
+
+		char *cq = static_cast<char *>(_map);
+		_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+		_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+		_cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+		_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+		setupBuffers(bufferCount);
+	}
+	catch (...)
+	{
+		release();
+		throw;
+	}
+}
+
+Ring::~Ring()
+{
+	release();
+}
+
+void Ring::release()
+{
+	if (_bufferRing != MAP_FAILED)
+		munmap(_bufferRing, _bufferRingSize);
+	delete[] _buffers;
+	if (_sqes != MAP_FAILED)
+		munmap(_sqes, _sqesSize);
+	if (_map != MAP_FAILED)
+		munmap(_map, _mapSize);
+	if (_fd >= 0)
+		close(_fd);
+	_bufferRing = static_cast<io_uring_buf *>(MAP_FAILED);
+	_buffers = NULL;
+	_sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+	_map = MAP_FAILED;
+	_fd = -1;
+}
+
+// The buffer ring lives in its own pages; the kernel takes buffers from
+// its head and the worker puts them back at its tail once consumed.
+void Ring::setupBuffers(unsigned count)
+{
+	_bufferRingSize = count * sizeof(io_uring_buf);
+	_bufferRing = static_cast<io_uring_buf *>(mmap(NULL, _bufferRingSize, PROT_READ | PROT_WRITE,
+		MAP_ANONYMOUS | MAP_PRIVATE, -1, 0));
+	if (_bufferRing == MAP_FAILED)
+		throw RingUnavailable();
+	_buffers = new char[count * BUFFER_SIZE];
+	_bufferCount = count;
+
+	io_uring_buf_reg registration;
+	std::memset(&registration, 0, sizeof(registration));
+	registration.ring_addr = reinterpret_cast<uintptr_t>(_bufferRing);
+	registration.ring_entries = count;
+	registration.bgid = 0;
+	if (syscall(__NR_io_uring_register, _fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+		throw RingUnavailable();
+
+	for (unsigned id = 0; id < count; ++id)
+		provideBuffer(id);
+}
+
+// The ring is addressed as a plain array: in C++ the header's bufs[] sits
+// behind an empty struct that takes a byte, which shifts it off the tail.
+void Ring::provideBuffer(unsigned id)
+{
+	io_uring_buf_ring *ring = reinterpret_cast<io_uring_buf_ring *>(_bufferRing);
+	unsigned short tail = ring->tail;
+	io_uring_buf *slot = &_bufferRing[tail & (_bufferCount - 1)];
+
+	slot->addr = reinterpret_cast<uintptr_t>(_buffers + id * BUFFER_SIZE);
+	slot->len = BUFFER_SIZE;
+	slot->bid = id;
+	__sync_synchronize();
+	ring->tail = tail + 1;
+}
+
+int Ring::enter(unsigned submit, unsigned waitFor, unsigned flags, void *arg, size_t argSize)
+{
+	return syscall(__NR_io_uring_enter, _fd, submit, waitFor, flags, arg, argSize);
+}
+
+// Without SQPOLL the kernel consumes the whole queue on every enter, so a
+// full queue only needs one submit to free up again.
+io_uring_sqe *Ring::nextSqe()
+{
+	if (_sqLocalTail - *_sqHead >= _sqEntries)
+		submit();
+
+	io_uring_sqe *sqe = &_sqes[_sqLocalTail & _sqMask];
+	std::memset(sqe, 0, sizeof(*sqe));
+	++_sqLocalTail;
+	return sqe;
+}
+
+void Ring::accept(int fd, uint64_t userData)
+{
+	io_uring_sqe *sqe = nextSqe();
+	sqe->opcode = IORING_OP_ACCEPT;
+	sqe->fd = fd;
+	sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+	sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+	sqe->user_data = userData;
+}
+
+void Ring::receive(int fd, uint64_t userData)
+{
+	io_uring_sqe *sqe = nextSqe();
+	sqe->opcode = IORING_OP_RECV;
+	sqe->fd = fd;
+	sqe->ioprio = IORING_RECV_MULTISHOT;
+	sqe->flags = IOSQE_BUFFER_SELECT;
+	sqe->buf_group = 0;
+	sqe->user_data = userData;
+}
+
+// MSG_DONTWAIT makes the kernel complete the send during the enter that
+// submits it, with -EAGAIN if the socket is full, instead of parking it
+// and reading the caller's iovecs later.
+void Ring::sendMessage(int fd, const msghdr *message, uint64_t userData)
+{
+	io_uring_sqe *sqe = nextSqe();
+	sqe->opcode = IORING_OP_SENDMSG;
+	sqe->fd = fd;
+	sqe->addr = reinterpret_cast<uintptr_t>(message);
+	sqe->len = 1;
+	sqe->msg_flags = MSG_NOSIGNAL | MSG_DONTWAIT;
+	sqe->user_data = userData;
+}
+
+void Ring::pollReadable(int fd, uint64_t userData, bool multishot)
+{
+	io_uring_sqe *sqe = nextSqe();
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->poll32_events = POLLIN;
+	sqe->len = multishot ? IORING_POLL_ADD_MULTI : 0;
+	sqe->user_data = userData;
+}
+
+void Ring::pollWritable(int fd, uint64_t userData)
+{
+	io_uring_sqe *sqe = nextSqe();
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = fd;
+	sqe->poll32_events = POLLOUT;
+	sqe->user_data = userData;
+}
+
+// The cancel request itself completes with user data 0
+void Ring::cancel(uint64_t target)
+{
+	io_uring_sqe *sqe = nextSqe();
+	sqe->opcode = IORING_OP_ASYNC_CANCEL;
+	sqe->fd = -1;
+	sqe->addr = target;
+	sqe->user_data = 0;
+}
+
+int Ring::submit()
+{
+	unsigned count = _sqLocalTail - *_sqHead;
+	if (count == 0)
+		return 0;
+	__sync_synchronize();
+	*_sqTail = _sqLocalTail;
+	return enter(count, 0, 0, NULL, 0);
+}
+
+// Submits whatever is queued and sleeps until a completion arrives or the
+// timeout passes, all in one enter. Returns the completions ready to reap.
+// EBUSY (completions overflowed) and EAGAIN (the kernel was short of
+// memory for the submissions) clear once the CQ is reaped, so they return what is ready and whatever
+// the kernel did not take goes in again on the next enter.
+int Ring::wait(int timeoutMs)
+{
+	unsigned count = _sqLocalTail - *_sqHead;
+	__sync_synchronize();
+	*_sqTail = _sqLocalTail;
+
+	int result;
+	if (timeoutMs < 0)
+		result = enter(count, 1, IORING_ENTER_GETEVENTS, NULL, 0);
+	else
+	{
+		__kernel_timespec timeout;
+		timeout.tv_sec = timeoutMs / 1000;
+		timeout.tv_nsec = (timeoutMs % 1000) * 1000000L;
+
+		io_uring_getevents_arg arg;
+		std::memset(&arg, 0, sizeof(arg));
+		arg.sigmask_sz = _NSIG / 8;
+		arg.ts = reinterpret_cast<uintptr_t>(&timeout);
+		result = enter(count, timeoutMs > 0 ? 1 : 0, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+	}
+	if (result < 0 && errno != ETIME && errno != EBUSY && errno != EAGAIN)
+		return -1;
+
+	unsigned tail = *_cqTail;
+	__sync_synchronize();
+	return tail - *_cqHead;
+}
+
+bool Ring::next(Completion &completion)
+{
+	unsigned head = *_cqHead;
+	unsigned tail = *_cqTail;
+	__sync_synchronize();
+	if (head == tail)
+		return false;
+
+	const io_uring_cqe &cqe = _cqes[head & _cqMask];
+	completion.userData = cqe.user_data;
+	completion.result = cqe.res;
+	completion.flags = cqe.flags;
+	__sync_synchronize();
+	*_cqHead = head + 1;
+	return true;
+}
+
+bool Ring::hasPending() const
+{
+	return _sqLocalTail != *_sqHead;
+}
+
+const char *Ring::buffer(const Completion &completion) const
+{
+	return _buffers + (completion.flags >> IORING_CQE_BUFFER_SHIFT) * BUFFER_SIZE;
+}
+
+void Ring::recycle(const Completion &completion)
+{
+	provideBuffer(completion.flags >> IORING_CQE_BUFFER_SHIFT);
+}
+
+bool Ring::isSupported()
+{
+	static int supported = -1;
+
+	if (supported < 0)
+	{
+		try
+		{
+			Ring probe(8, 8);
+			supported = 1;
+		}
+		catch (const RingUnavailable &)
+		{
+			supported = 0;
+		}
+	}
+	return supported == 1;
+}
+
+const char *Ring::RingUnavailable::what() const throw()
+{
+	return "io_uring is unavailable or lacks multishot receive and provided buffers.";
+}
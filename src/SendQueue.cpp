@@ -0,0 +1,206 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SendQueue.cpp                                      :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/22 16:05:48 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/22 16:05:48 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/SendQueue.hpp"
+
+SendQueue::SendQueue() : _headOffset(0), _queuedBytes(0)
+{
+}
+
+SendQueue::~SendQueue()
+{
+	clear();
+}
+
+char *SendQueue::Chunk::data()
+{
+	return reinterpret_cast<char *>(this + 1);
+}
+
+const char *SendQueue::Segment::data() const
+{
+	if (payload)
+		return payload->data();
+	return chunk->data();
+}
+
+size_t SendQueue::Segment::length() const
+{
+	if (payload)
+		return payload->length();
+	return chunk->length;
+}
+
+SendQueue::Chunk *SendQueue::createChunk(size_t capacity)
+{
+	Chunk *chunk = static_cast<Chunk *>(::operator new(sizeof(Chunk) + capacity));
+	chunk->length = 0;
+	chunk->capacity = capacity;
+	return chunk;
+}
+
+void SendQueue::releaseSegment(Segment &segment)
+{
+	if (segment.payload)
+		segment.payload->release();
+	else
+		::operator delete(segment.chunk);
+}
+
+// SendQ limits count queued bytes, not chunk memory, so a chunk that starts
+// the queue or follows a payload is sized to what is appended; otherwise a
+// slow reader in a busy channel would pin CHUNK_SIZE per small reply. A run
+// of appends doubles the chunk size up to CHUNK_SIZE.
+void SendQueue::append(const char *data, size_t length)
+{
+	while (length > 0)
+	{
+		Segment *last = _segments.empty() ? NULL : &_segments.back();
+		if (!last || last->payload || last->chunk->length == last->chunk->capacity)
+		{
+			size_t capacity = (last && !last->payload) ? last->chunk->capacity * 2 : MIN_CHUNK_SIZE;
+			while (capacity < length && capacity < CHUNK_SIZE)
+				capacity *= 2;
+			if (capacity > CHUNK_SIZE)
+				capacity = CHUNK_SIZE;
+
+			Segment segment;
+			segment.chunk = createChunk(capacity);
+			segment.payload = NULL;
+			_segments.push_back(segment);
+		}
+
+		Chunk *tail = _segments.back().chunk;
+		size_t room = tail->capacity - tail->length;
+		size_t count = length < room ? length : room;
+
+		std::memcpy(tail->data() + tail->length, data, count);
+		tail->length += count;
+		_queuedBytes += count;
+		data += count;
+		length -= count;
+	}
+}
+
+void SendQueue::append(const std::string &data)
+{
+	append(data.data(), data.length());
+}
+
+void SendQueue::append(SharedPayload *payload)
+{
+	if (payload->length() == 0)
+		return;
+
+	Segment segment;
+	segment.chunk = NULL;
+	segment.payload = payload;
+	payload->retain();
+	_segments.push_back(segment);
+	_queuedBytes += payload->length();
+}
+
+// Moves every segment of other to the tail of this queue without copying
+// or touching reference counts; other is left empty.
+void SendQueue::splice(SendQueue &other)
+{
+	if (other._segments.empty())
+		return;
+
+	if (other._headOffset > 0)
+	{
+		Segment &head = other._segments.front();
+		append(head.data() + other._headOffset, head.length() - other._headOffset);
+		other._queuedBytes -= head.length() - other._headOffset;
+		releaseSegment(head);
+		other._segments.pop_front();
+		other._headOffset = 0;
+	}
+	_segments.insert(_segments.end(), other._segments.begin(), other._segments.end());
+	_queuedBytes += other._queuedBytes;
+	other._segments.clear();
+	other._queuedBytes = 0;
+}
+
+void SendQueue::clear()
+{
+	for (std::deque<Segment>::iterator it = _segments.begin(); it != _segments.end(); ++it)
+		releaseSegment(*it);
+	_segments.clear();
+	_headOffset = 0;
+	_queuedBytes = 0;
+}
+
+ssize_t SendQueue::flush(int fd)
+{
+	if (_segments.empty())
+		return 0;
+
+	struct iovec iov[MAX_IOVECS];
+
+	struct msghdr msg;
+	std::memset(&msg, 0, sizeof(msg));
+	msg.msg_iov = iov;
+	msg.msg_iovlen = gather(iov, MAX_IOVECS);
+
+	ssize_t written = sendmsg(fd, &msg, MSG_NOSIGNAL);
+	if (written > 0)
+		consume(written);
+	return written;
+}
+
+// Describes the head of the queue without consuming it; the segments stay
+// put until consume(), so the vectors remain valid while a write is out.
+size_t SendQueue::gather(struct iovec *iov, size_t max) const
+{
+	size_t count = 0;
+
+	for (std::deque<Segment>::const_iterator it = _segments.begin(); it != _segments.end() && count < max; ++it)
+	{
+		size_t offset = (count == 0) ? _headOffset : 0;
+		iov[count].iov_base = const_cast<char *>(it->data() + offset);
+		iov[count].iov_len = it->length() - offset;
+		++count;
+	}
+	return count;
+}
+
+void SendQueue::consume(size_t bytes)
+{
+	_queuedBytes -= bytes;
+	while (bytes > 0)
+	{
+		Segment &head = _segments.front();
+		size_t available = head.length() - _headOffset;
+
+		if (bytes < available)
+		{
+			_headOffset += bytes;
+			return;
+		}
+
+		bytes -= available;
+		releaseSegment(head);
+		_segments.pop_front();
+		_headOffset = 0;
+	}
+}
+
+bool SendQueue::empty() const
+{
+	return _queuedBytes == 0;
+}
+
+size_t SendQueue::size() const
+{
+	return _queuedBytes;
+}
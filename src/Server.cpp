@@ -14,271 +14,775 @@
 
 bool Server::shouldStop = false;
 
-Server::Server(const std::string &portStr, const std::string &password, const std::string &hostname) : password(password), hostname(hostname)
+Server::Stats::Stats() : sendqDropped(0), sendqExceeded(0), floodDeferred(0), floodExcess(0)
 {
-	std::cout << "Server initializing..." << std::endl;
+}
+
+// Shards count SendQ drops on their own thread while the hub reads them
+Server::Stats Server::Stats::snapshot()
+{
+	Stats copy;
+	copy.sendqDropped = __sync_fetch_and_add(&sendqDropped, 0);
+	copy.sendqExceeded = __sync_fetch_and_add(&sendqExceeded, 0);
+	copy.floodDeferred = __sync_fetch_and_add(&floodDeferred, 0);
+	copy.floodExcess = __sync_fetch_and_add(&floodExcess, 0);
+	return copy;
+}
+
+Server::Server(const std::string &portStr, const std::string &password, const std::string &hostname, const Config &config)
+	: password(password), hostname(hostname),
+	  clientPool("client", poolSize(config, "client_pool", 1024)),
+	  channelPool("channel", poolSize(config, "channel_pool", 256)),
+	  membershipPool("membership", MEMBERSHIP_NODE, poolSize(config, "membership_pool", 4096)),
+	  config(config), throttle(config),
+	  threaded(config.getNumber("workers", 1) > 1),
+	  fanoutEpoch(0),
+	  pingIntervalMs(durationMs(config, "ping_interval", 120, 1, MAX_TIMEOUT)),
+	  pingTimeoutMs(durationMs(config, "ping_timeout", 60, 1, MAX_TIMEOUT)),
+	  registrationTimeoutMs(durationMs(config, "registration_timeout", 60, 1, MAX_TIMEOUT)),
+	  maxLineLength(config.getNumber("max_line_length", LineBuffer::MAX_LINE)),
+	  readBudget(config.getNumber("read_budget", 16384)),
+	  commandBudget(config.getNumber("command_budget", 32)),
+	  acceptBudget(config.getNumber("accept_budget", 64)),
+	  ringBuffers(config.getNumber("io_uring_buffers", 256)),
+	  floodBurstMs(durationMs(config, "flood_burst", 0, 0, 3600)),
+	  floodMaxDeferred(config.getNumber("flood_max_deferred", 8192)),
+	  unregisteredClass("unregistered", 8192, 16384),
+	  userClass("user", 524288, 1048576),
+	  hub(NULL), nextRequest(0), shardStarted(false), shardStopping(false)
+{
+	LOG(NET, INFO) << "Server initializing...";
 
 	checkArgPort(portStr);
 	checkArgPassword(password);
+	if (maxLineLength < LineBuffer::MAX_LINE || maxLineLength > LineBuffer::MAX_TAGGED_LINE)
+		throw Config::InvalidConfigValue();
+	if (readBudget == 0 || commandBudget == 0 || acceptBudget == 0)
+		throw Config::InvalidConfigValue();
+	if (ringBuffers < 16 || ringBuffers > 32768 || (ringBuffers & (ringBuffers - 1)) != 0)
+		throw Config::InvalidConfigValue();
+	if (floodMaxDeferred < maxLineLength)
+		throw Config::InvalidConfigValue();
+	unregisteredClass.load(config);
+	userClass.load(config);
 	creationTime = getCurrentTime();
 	signal(SIGINT, Server::signalHandler);
-	this->serverSocket = socket(AF_INET, SOCK_STREAM, 0);
-	if (this->serverSocket < 0)
-	{
-		throw SocketCreationFailed();
-	}
 
-	int opt = 1;
-	if (setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
-	{
-		throw SocketCreationFailed();
-	}
-	this->serverAddress.sin_family = AF_INET;
-	this->serverAddress.sin_port = htons(this->port);
-	this->serverAddress.sin_addr.s_addr = INADDR_ANY;
-	setNonBlocking(this->serverSocket);
+	size_t workerCount = config.getNumber("workers", 1);
+	if (workerCount == 0 || workerCount > 64)
+		throw Config::InvalidConfigValue();
+	Reactor::Backend backend = Reactor::parseBackend(config.getString("io_backend", "epoll"));
+	for (size_t i = 0; i < workerCount; ++i)
+		workers.push_back(new Worker(this, i, backend, threaded));
+
+	size_t shardCount = config.getNumber("channel_shards", 0);
+	if (shardCount > 64 || (shardCount > 0 && !threaded))
+		throw Config::InvalidConfigValue();
+	for (size_t i = 0; i < shardCount; ++i)
+		shards.push_back(new Server(*this, shardCount));
+}
+
+// A channel shard: owns a slice of the channels and a shadow Client for
+// everyone it has heard of, and writes to the hub's workers directly. Its
+// pools start with an even share of the configured sizes and grow from
+// there, so adding shards does not multiply the startup footprint.
+Server::Server(Server &owner, size_t shardCount)
+	: port(owner.port), password(owner.password), hostname(owner.hostname),
+	  creationTime(owner.creationTime),
+	  clientPool("client", owner.clientPool.getCapacity() / shardCount),
+	  channelPool("channel", owner.channelPool.getCapacity() / shardCount),
+	  membershipPool("membership", MEMBERSHIP_NODE, owner.membershipPool.getCapacity() / shardCount),
+	  config(owner.config), throttle(owner.config),
+	  workers(owner.workers), threaded(true),
+	  fanoutEpoch(0),
+	  pingIntervalMs(owner.pingIntervalMs),
+	  pingTimeoutMs(owner.pingTimeoutMs),
+	  registrationTimeoutMs(owner.registrationTimeoutMs),
+	  maxLineLength(owner.maxLineLength),
+	  readBudget(owner.readBudget),
+	  commandBudget(owner.commandBudget),
+	  acceptBudget(owner.acceptBudget),
+	  ringBuffers(owner.ringBuffers),
+	  floodBurstMs(owner.floodBurstMs),
+	  floodMaxDeferred(owner.floodMaxDeferred),
+	  unregisteredClass(owner.unregisteredClass),
+	  userClass(owner.userClass),
+	  hub(&owner), nextRequest(0), shardStarted(false), shardStopping(false)
+{
+}
 
-	pollfd server_pollfd;
-	server_pollfd.fd = serverSocket;
-	server_pollfd.events = POLLIN;
-	server_pollfd.revents = 0;
-	poll_fds.push_back(server_pollfd);
+// Checked before the pools preallocate anything
+size_t Server::poolSize(const Config &config, const std::string &key, size_t fallback)
+{
+	size_t size = config.getNumber(key, fallback);
+	if (size > MAX_POOL)
+		throw Config::InvalidConfigValue();
+	return size;
+}
+
+// Seconds from the config, range-checked before they are scaled so a huge
+// value cannot wrap around into a tiny timeout
+unsigned long Server::durationMs(const Config &config, const std::string &key, unsigned long fallback,
+	unsigned long min, unsigned long max)
+{
+	unsigned long seconds = config.getNumber(key, fallback);
+	if (seconds < min || seconds > max)
+		throw Config::InvalidConfigValue();
+	return seconds * 1000;
 }
 
 void Server::bindAndListen()
 {
-	if (bind(this->serverSocket, (struct sockaddr *)&this->serverAddress, sizeof(this->serverAddress)) < 0)
-	{
-		throw SocketBindFailed();
-	}
-	if (listen(this->serverSocket, SOMAXCONN) < 0)
-	{
-		throw SocketListenFailed();
-	}
-	std::cout << "Server is listening on port " << this->port << std::endl;
+	for (size_t i = 0; i < workers.size(); ++i)
+		workers[i]->listen(port, threaded);
+	LOG(NET, INFO) << "Server is listening on port " << this->port
+		<< " (" << Reactor::backendName(workers[0]->getBackend())
+		<< ", " << workers.size() << " worker" << (workers.size() > 1 ? "s" : "") << ")";
 }
 
+// With one worker its reactor is the loop's wait; with several the hub
+// sleeps on its mailbox and the workers run their own loops.
 void Server::runServer()
 {
+	startWorkers();
+	// Only the hub writes the log; the timer bounds how long records from
+	// workers and shards wait when nothing else wakes it
+	if (threaded || !shards.empty())
+		timers.schedule(logTimer, LOG_FLUSH_MS);
 	while (!shouldStop)
 	{
-		int poll_count = poll(&poll_fds[0], poll_fds.size(), -1);
-
-		if (poll_count < 0)
+		Logger::flush();
+		int ready_count;
+		if (threaded)
+			ready_count = inbox.wait(timers.timeoutMs());
+		else
+			ready_count = workers[0]->wait(workers[0]->hasReadyConnections() ? 0 : timers.timeoutMs());
+		timers.advance();
+
+		if (ready_count < 0)
 		{
-			if (!shouldStop)
+			if (!shouldStop && errno != EINTR)
 			{
 				throw PollFailed();
 			}
-			break;
+			continue;
 		}
 
-		for (size_t i = 0; i < poll_fds.size(); ++i)
+		if (threaded)
+			handleMailbox();
+		else
+			workers[0]->dispatch();
+
+		TimerWheel::Timer *timer;
+		while ((timer = timers.popExpired()) != NULL)
 		{
-			if (poll_fds[i].revents & POLLIN)
-			{
-				if (poll_fds[i].fd == serverSocket)
-				{
-					int client_fd = accept(serverSocket, NULL, NULL);
-					if (client_fd >= 0)
-						addClient(client_fd);
-				}
-				else
-					handleClientData(poll_fds[i]);
-			}
-			if (poll_fds[i].revents & POLLOUT)
-			{
-				if (poll_fds[i].fd != serverSocket)
-				{
-					if (poll_fds[i].events & POLLOUT)
-					{
-						std::map<int, Client *>::iterator it = clients.find(poll_fds[i].fd);
-						if (it != clients.end())
-						{
-							Client *client = it->second;
-							std::string sendBuffer = client->getSendBuffer();
-							if (!sendBuffer.empty())
-							{
-								std::cout << "Sending to client " << client->getClientFd() << ": " << sendBuffer << std::endl;
-								sendToClient(poll_fds[i], client);
-							}
-						}
-					}
-				}
-			}
+			if (timer == &logTimer)
+				timers.schedule(logTimer, LOG_FLUSH_MS);
+			else if (timer == &timer->client->getFloodTimer())
+				drainDeferred(timer->client);
+			else
+				handleTimeout(timer->client);
 		}
+
+		closePending();
+		flushDirtyClients();
 	}
 
 	if (shouldStop)
 	{
-		std::cout << "Shutdown signal received." << std::endl;
+		LOG(NET, INFO) << "Shutdown signal received.";
 	}
+	stopWorkers();
+	Logger::flush();
 }
 
 void Server::setNonBlocking(int fd)
 {
-	if (fcntl(fd, F_SETFL, O_NONBLOCK) == -1)
+	int flags = fcntl(fd, F_GETFL);
+	if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1)
 	{
 		throw NonBlockingFailed();
 	}
 }
 
-void Server::addClient(int client_fd)
+Client *Server::attachClient(int fd, int id)
 {
-	try
+	Client *newClient = clientPool.create(fd, id, membershipPool);
+	newClient->setHostname(hostname);
+	newClient->setConnectionClass(&unregisteredClass);
+	newClient->touch(timers.now());
+	timers.schedule(newClient->getTimer(), registrationTimeoutMs);
+	clients[id] = newClient;
+	return newClient;
+}
+
+// Undoes attachClient for a client that never got as far as the reactor
+void Server::detachClient(Client *client)
+{
+	timers.cancel(client->getTimer());
+	clients.erase(client->getId());
+	clientPool.destroy(client);
+}
+
+Client *Server::findClient(int id)
+{
+	if (!threaded)
+		return static_cast<Client *>(workers[0]->getConnection(id));
+
+	std::map<int, Client *>::iterator it = clients.find(id);
+	if (it == clients.end())
+		return NULL;
+	return it->second;
+}
+
+void Server::removeClient(int client_fd)
+{
+	Client *client = findClient(client_fd);
+
+	if (client)
+		leaveChannels(client);
+
+	LOG(NET, DEBUG) << "Removing client: " << client_fd;
+
+	if (client)
 	{
-		setNonBlocking(client_fd);
+		timers.cancel(client->getTimer());
+		timers.cancel(client->getFloodTimer());
+		if (!client->getNickname().empty())
+			nicknames.erase(client->getNickname());
+		clients.erase(client_fd);
+		if (threaded)
+		{
+			workers[client->getWorker()]->getInbox().post(new Mailbox::Message(Mailbox::Message::CLOSE, client_fd));
+			for (size_t i = 0; client->isRegistered() && i < shards.size(); ++i)
+				shards[i]->getInbox().post(new Mailbox::Message(Mailbox::Message::CLOSE, client_fd));
+		}
+		else
+			workers[0]->closeConnection(client);
+		clientPool.destroy(client);
+	}
 
-		Client *newClient = new Client(client_fd);
-		clients[client_fd] = newClient;
+	LOG(NET, INFO) << "Client disconnected: " << client_fd;
+}
 
-		pollfd client_pollfd;
-		client_pollfd.fd = client_fd;
-		client_pollfd.events = POLLIN;
-		client_pollfd.revents = 0;
-		poll_fds.push_back(client_pollfd);
+void Server::leaveChannels(Client *client)
+{
+	std::vector<Channel *> joined(client->getChannels().begin(), client->getChannels().end());
 
-		std::cout << "New client connected: " << client_fd << std::endl;
+	for (size_t i = 0; i < joined.size(); ++i)
+	{
+		joined[i]->removeUser(client->getClientFd());
+		if (joined[i]->isChannelEmpty())
+		{
+			std::string name = joined[i]->getName();
+			removeChannel(name);
+		}
 	}
-	catch (const std::exception &e)
+}
+
+void Server::deliverLine(Client *client, const char *line, size_t length)
+{
+	client->touch(timers.now());
+	IRCMessage ircMsg = CommandParser::parseMessage(line, length);
+
+	// Free commands (PONG, QUIT) skip the flood queue, so a flooding client
+	// still answers PINGs and can leave; a pending fan-out holds them too
+	bool free = CommandExecuter::getCommandEntry(ircMsg.getCommandId()).cost == 0;
+	if (client->isFanoutPending() || (!free && (client->hasDeferredLines()
+		|| (floodBurstMs > 0 && client->getFloodLag(timers.now()) > floodBurstMs))))
+		deferLine(client, line, length);
+	else
+		runLine(client, ircMsg, line, length);
+}
+
+// Each command moves the client's flood clock ahead by its cost; once the
+// clock runs more than the burst ahead of real time, lines are held back
+// and fed in again by the flood timer as the clock catches up. They also
+// wait while a NICK or QUIT fan-out is out at the shards, so nothing the
+// client says next can reach a peer ahead of it.
+void Server::runLine(Client *client, const IRCMessage &ircMsg, const char *line, size_t length)
+{
+	if (floodBurstMs > 0)
+		client->chargeFlood(timers.now(), CommandExecuter::getCommandEntry(ircMsg.getCommandId()).cost);
+
+	Server *shard = shardFor(ircMsg);
+	if (!shard)
 	{
-		std::cerr << "Error adding client: " << client_fd << " - " << e.what() << '\n';
+		CommandExecuter::executeCommand(this, client, ircMsg);
 		return;
 	}
+	if (CommandExecuter::admitCommand(this, client, ircMsg))
+		forwardToShard(shard, client, ircMsg, line, length);
 }
 
-void Server::removeClient(int client_fd)
+void Server::deferLine(Client *client, const char *line, size_t length)
 {
-	std::vector<std::string> channelsToRemove;
+	client->deferLine(line, length);
+	if (client->getDeferredBytes() > floodMaxDeferred)
+	{
+		++stats.floodExcess;
+		closeLater(client, "Excess Flood");
+		return;
+	}
+	// finishFanout resumes the client
+	if (client->isFanoutPending() || floodBurstMs == 0)
+		return;
+	client->addFloodPenalty();
+	++stats.floodDeferred;
+	scheduleDrain(client);
+}
 
-	for (std::map<std::string, Channel *>::iterator it = channels.begin(); it != channels.end(); ++it)
+void Server::scheduleDrain(Client *client)
+{
+	unsigned long lag = client->getFloodLag(timers.now());
+	if (!client->getFloodTimer().pending())
+		timers.schedule(client->getFloodTimer(), lag > floodBurstMs ? lag - floodBurstMs : 0);
+}
+
+void Server::drainDeferred(Client *client)
+{
+	int id = client->getClientFd();
+
+	while (client->hasDeferredLines() && !client->isFanoutPending()
+		&& (floodBurstMs == 0 || client->getFloodLag(timers.now()) <= floodBurstMs))
 	{
-		Channel *channel = it->second;
-		if (channel && channel->isUserInChannel(client_fd))
-		{
-			channel->removeUser(client_fd);
-			if (channel->isChannelEmpty())
-			{
-				channelsToRemove.push_back(channel->getName());
-			}
-		}
+		std::string line = client->popDeferredLine();
+		runLine(client, CommandParser::parseMessage(line.data(), line.length()), line.data(), line.length());
+		if (findClient(id) != client || client->isClosing())
+			return;
 	}
+	if (client->hasDeferredLines() && !client->isFanoutPending())
+		scheduleDrain(client);
+}
 
-	for (size_t i = 0; i < channelsToRemove.size(); ++i)
+void Server::deliverOverlong(Client *client)
+{
+	client->writeAndEnablePollOut(this, IRCResponse::createErrorInputTooLong(
+		client->getNickname().empty() ? "*" : client->getNickname()));
+}
+
+void Server::markClientForSending(Client *client)
+{
+	if (client->isDirty())
+		return;
+	client->setDirty(true);
+	dirtyClients.push_back(client->getClientFd());
+}
+
+// Output queued during an iteration goes out in one write per client
+void Server::flushDirtyClients()
+{
+	for (size_t i = 0; i < dirtyClients.size(); ++i)
 	{
-		removeChannel(channelsToRemove[i]);
+		Client *client = findClient(dirtyClients[i]);
+		if (!client || !client->isDirty())
+			continue;
+		client->setDirty(false);
+
+		if (client->isClosing())
+			continue;
+		if (threaded)
+			shipOutput(client);
+		else
+			workers[0]->send(client);
 	}
+	dirtyClients.clear();
+}
 
-	std::cout << "Removing client: " << client_fd << std::endl;
+void Server::startWorkers()
+{
+	if (!threaded)
+		return;
 
-	std::map<int, Client *>::iterator it = clients.find(client_fd);
-	if (it != clients.end())
+	// SIGINT must land on the hub, the only thread that polls for it
+	sigset_t blocked;
+	sigset_t previous;
+	sigemptyset(&blocked);
+	sigaddset(&blocked, SIGINT);
+	pthread_sigmask(SIG_BLOCK, &blocked, &previous);
+	for (size_t i = 0; i < workers.size(); ++i)
+		workers[i]->start();
+	for (size_t i = 0; i < shards.size(); ++i)
 	{
-		delete it->second;
-		clients.erase(it);
+		if (pthread_create(&shards[i]->shardThread, NULL, &Server::shardMain, shards[i]) != 0)
+			throw Worker::WorkerStartFailed();
+		shards[i]->shardStarted = true;
 	}
+	pthread_sigmask(SIG_SETMASK, &previous, NULL);
+}
 
-	for (std::vector<pollfd>::iterator it = poll_fds.begin(); it != poll_fds.end(); ++it)
+void Server::stopWorkers()
+{
+	for (size_t i = 0; i < shards.size(); ++i)
 	{
-		if (it->fd == client_fd)
+		if (!shards[i]->shardStarted)
+			continue;
+		shards[i]->shardStopping = true;
+		shards[i]->inbox.wake();
+		pthread_join(shards[i]->shardThread, NULL);
+		shards[i]->shardStarted = false;
+	}
+	for (size_t i = 0; !hub && i < workers.size(); ++i)
+		workers[i]->stop();
+}
+
+// Messages from one worker arrive in order, and ids are never reused, so a
+// message for a client the hub already dropped is simply ignored.
+void Server::handleMailbox()
+{
+	Mailbox::Message *message = inbox.collect();
+
+	while (message)
+	{
+		Mailbox::Message *next = message->next;
+
+		if (message->type == Mailbox::Message::CONNECT)
 		{
-			poll_fds.erase(it);
-			break;
+			Client *client = attachClient(-1, message->id);
+			client->setWorker(message->worker);
+			client->setBacklog(message->backlog);
 		}
-	}
+		else
+		{
+			Client *client = findClient(message->id);
+			if (message->type == Mailbox::Message::PEERS)
+			{
+				std::map<unsigned long, PendingFanout>::iterator it = pendingFanouts.find(message->request);
+				if (it != pendingFanouts.end())
+				{
+					it->second.peers.insert(it->second.peers.end(), message->ids.begin(), message->ids.end());
+					if (--it->second.waiting == 0)
+					{
+						int origin = it->second.origin;
+						deliverFanout(it->second);
+						pendingFanouts.erase(it);
+						finishFanout(origin);
+					}
+				}
+			}
+			else if (client && message->type == Mailbox::Message::DISCONNECT)
+				closeLater(client, message->text);
+			else if (client && message->type == Mailbox::Message::INPUT)
+			{
+				for (unsigned int i = 0; i < message->overlong; ++i)
+					deliverOverlong(client);
 
-	close(client_fd);
-	std::cout << "Client disconnected: " << client_fd << std::endl;
+				size_t start = 0;
+				size_t end;
+				while (!client->isClosing() && (end = message->text.find('\n', start)) != std::string::npos)
+				{
+					deliverLine(client, message->text.data() + start, end - start);
+					if (findClient(message->id) != client)
+						break;
+					start = end + 1;
+				}
+			}
+		}
+		delete message;
+		message = next;
+	}
 }
 
-void Server::handleClientData(pollfd &clientPfd)
+Server *Server::shardFor(const IRCMessage &msg)
 {
-	char buffer[4096];
-	std::map<int, Client *>::iterator it = clients.find(clientPfd.fd);
-	if (it == clients.end())
-		return;
+	if (shards.empty() || msg.paramCount() == 0)
+		return NULL;
 
-	size_t bytes_read = recv(clientPfd.fd, buffer, sizeof(buffer) - 1, 0);
+	std::string name = msg.getParam(0);
+	if (name.empty())
+		return NULL;
+	switch (msg.getCommandId())
+	{
+		case CMD_JOIN:
+			if (name[0] != '#')
+				name = "#" + name;
+			break;
+		case CMD_PART:
+		case CMD_KICK:
+		case CMD_TOPIC:
+			break;
+		case CMD_MODE:
+		case CMD_PRIVMSG:
+			if (name[0] != '#')
+				return NULL;
+			break;
+		case CMD_INVITE:
+			if (msg.paramCount() < 2)
+				return NULL;
+			name = msg.getParam(1);
+			if (name.empty())
+				return NULL;
+			break;
+		default:
+			return NULL;
+	}
+	return shards[NickIndex::hash(name) % shards.size()];
+}
 
-	if (bytes_read <= 0)
+// The parameters that can name a client travel with the command, so KICK,
+// INVITE and MODE +o can find their target on the shard. Message text and
+// topics are left alone, or any word matching a nick would make a shadow.
+void Server::forwardToShard(Server *shard, Client *client, const IRCMessage &msg, const char *line, size_t length)
+{
+	Mailbox::Message *message = new Mailbox::Message(Mailbox::Message::COMMAND, client->getClientFd());
+	message->text.assign(line, length);
+	attachIdentity(message, client);
+
+	size_t first = 0;
+	size_t last = 0;
+	if (msg.getCommandId() == CMD_KICK)
 	{
-		CommandExecuter::handleDisconnection(this, it->second, "Disconnected.");
-		return;
+		first = 1;
+		last = 2;
 	}
+	else if (msg.getCommandId() == CMD_INVITE)
+		last = 1;
+	else if (msg.getCommandId() == CMD_MODE)
+	{
+		first = 2;
+		last = msg.paramCount();
+	}
+	for (size_t i = first; i < last && i < msg.paramCount(); ++i)
+	{
+		Client *target = getClientByNickname(msg.getParam(i));
+		if (target && target != client && target->isRegistered())
+			attachIdentity(message, target);
+	}
+	shard->getInbox().post(message);
+}
 
-	buffer[bytes_read] = '\0';
-	it->second->appendToReadBuffer(std::string(buffer));
-	std::cout << "Received from client " << clientPfd.fd << ": " << buffer << std::endl;
+void Server::attachIdentity(Mailbox::Message *message, Client *client)
+{
+	Mailbox::Identity identity;
+	identity.id = client->getClientFd();
+	identity.worker = client->getWorker();
+	identity.nickname = client->getNickname();
+	identity.username = client->getUsername();
+	identity.hostname = client->getHostname();
+	identity.connectionClass = client->getConnectionClass();
+	identity.backlog = client->getBacklog();
+	message->attach(identity);
+}
 
-	it = clients.find(clientPfd.fd);
-	if (it == clients.end())
-		return;
+// Shadows share the hub client's backlog, so SendQ limits still see
+// everything queued for the connection.
+Client *Server::adoptIdentity(const Mailbox::Identity &identity, bool create)
+{
+	Client *shadow = findClient(identity.id);
+	if (!shadow)
+	{
+		if (!create)
+			return NULL;
+		shadow = clientPool.create(-1, identity.id, membershipPool);
+		shadow->setWorker(identity.worker);
+		shadow->setBacklog(identity.backlog);
+		shadow->setRegistered(true);
+		shadow->setUsername(identity.username);
+		shadow->setHostname(identity.hostname);
+		clients[identity.id] = shadow;
+	}
+	if (shadow->getNickname() != identity.nickname)
+		changeNickname(shadow, identity.nickname);
+	shadow->setConnectionClass(identity.connectionClass);
+	return shadow;
+}
 
-	Client *client = it->second;
-	std::string &readBuffer = client->getReadBuffer();
-	size_t pos;
+void Server::handleShardMailbox()
+{
+	Mailbox::Message *message = inbox.collect();
 
-	while ((pos = readBuffer.find("\r\n")) != std::string::npos)
+	while (message)
 	{
-		std::string message = readBuffer.substr(0, pos);
-		readBuffer.erase(0, pos + 2);
+		Mailbox::Message *next = message->next;
+		bool create = message->type == Mailbox::Message::COMMAND;
 
-		if (!message.empty())
+		for (size_t i = 0; i < message->identities.size(); ++i)
+			adoptIdentity(message->identities[i], create);
+
+		Client *client = findClient(message->id);
+		if (message->type == Mailbox::Message::COMMAND && client && !client->isClosing())
+		{
+			IRCMessage ircMsg = CommandParser::parseMessage(message->text.data(), message->text.length());
+			CommandExecuter::getCommandEntry(ircMsg.getCommandId()).handler(this, client, ircMsg);
+		}
+		else if (message->type == Mailbox::Message::COLLECT)
+		{
+			Mailbox::Message *reply = new Mailbox::Message(Mailbox::Message::PEERS, message->id);
+			reply->request = message->request;
+			if (client)
+			{
+				++fanoutEpoch;
+				client->markForFanout(fanoutEpoch);
+				const Client::ChannelSet &joined = client->getChannels();
+				for (Client::ChannelSet::const_iterator ch = joined.begin(); ch != joined.end(); ++ch)
+				{
+					const Channel::Members &users = (*ch)->getUsers();
+					for (Channel::Members::const_iterator it = users.begin(); it != users.end(); ++it)
+					{
+						if (it->second->markForFanout(fanoutEpoch))
+							reply->ids.push_back(it->first);
+					}
+				}
+			}
+			hub->getInbox().post(reply);
+		}
+		else if (message->type == Mailbox::Message::CLOSE && client)
 		{
-			IRCMessage ircMsg = CommandParser::parseMessage(message);
-			CommandExecuter::executeCommand(this, client, ircMsg);
-			if (clients.find(clientPfd.fd) == clients.end())
-				return;
+			leaveChannels(client);
+			if (!client->getNickname().empty())
+				nicknames.erase(client->getNickname());
+			clients.erase(message->id);
+			clientPool.destroy(client);
 		}
+		delete message;
+		message = next;
+	}
+}
+
+void Server::deliverFanout(PendingFanout &pending)
+{
+	++fanoutEpoch;
+	Client *origin = findClient(pending.origin);
+	if (origin)
+		origin->markForFanout(fanoutEpoch);
+
+	for (size_t i = 0; i < pending.peers.size(); ++i)
+	{
+		Client *peer = findClient(pending.peers[i]);
+		if (peer && peer->markForFanout(fanoutEpoch))
+			peer->writeAndEnablePollOut(this, pending.payload);
 	}
+	pending.payload->release();
 }
 
+// The fan-out is shipped to the workers before the client's held lines
+// run, so whatever the shards send for them is queued behind it.
+void Server::finishFanout(int id)
+{
+	Client *client = findClient(id);
+	if (!client || client->endFanout() > 0)
+		return;
+	flushDirtyClients();
+	if (!client->isClosing())
+		drainDeferred(client);
+}
 
-void Server::sendToClient(pollfd &clientPfd, Client *client)
+void Server::runShard()
 {
-	int bytes_sent = send(clientPfd.fd, client->getSendBuffer().c_str(), client->getSendBuffer().length(), 0);
-	if (bytes_sent > 0)
+	while (!shardStopping)
 	{
-		client->getSendBuffer().erase(0, bytes_sent);
-		if (client->getSendBuffer().empty())
-			clientPfd.events &= ~POLLOUT;
+		if (inbox.wait(-1) < 0 && errno != EINTR)
+		{
+			LOG(CHANNEL, ERROR) << "Channel shard stopped: " << std::strerror(errno);
+			return;
+		}
+		handleShardMailbox();
+		closePending();
+		flushDirtyClients();
 	}
 }
 
-void Server::markClientForSending(int client_fd)
+void *Server::shardMain(void *shard)
 {
-	for (size_t i = 0; i < poll_fds.size(); ++i)
+	try
 	{
-		if (poll_fds[i].fd == client_fd)
+		static_cast<Server *>(shard)->runShard();
+	}
+	catch (const std::exception &e)
+	{
+		LOG(CHANNEL, ERROR) << "Channel shard stopped: " << e.what();
+	}
+	return NULL;
+}
+
+// The outbox is handed over whole; the backlog keeps counting it against
+// the SendQ limits until the worker has written it.
+void Server::shipOutput(Client *client)
+{
+	SendQueue &outbox = client->getSendQueue();
+	if (outbox.empty())
+		return;
+
+	Mailbox::Message *message = new Mailbox::Message(Mailbox::Message::OUTPUT, client->getClientFd());
+	client->getBacklog()->add(outbox.size());
+	message->output.splice(outbox);
+	workers[client->getWorker()]->getInbox().post(message);
+}
+
+void Server::broadcastToPeers(Client *client, const ReplyBuffer &reply, bool includeSelf)
+{
+	SharedPayload *payload = SharedPayload::create(reply.data(), reply.length());
+
+	// Sharded channels: ask every shard for the peers, send once all answered
+	if (!shards.empty())
+	{
+		if (includeSelf)
+			client->writeAndEnablePollOut(this, payload);
+
+		client->beginFanout();
+		PendingFanout &pending = pendingFanouts[++nextRequest];
+		pending.payload = payload;
+		pending.origin = client->getClientFd();
+		pending.waiting = shards.size();
+		for (size_t i = 0; i < shards.size(); ++i)
 		{
-			if (!(poll_fds[i].events & POLLOUT))
-				poll_fds[i].events |= POLLOUT;
-			break;
+			Mailbox::Message *message = new Mailbox::Message(Mailbox::Message::COLLECT, client->getClientFd());
+			message->request = nextRequest;
+			shards[i]->getInbox().post(message);
+		}
+		return;
+	}
+
+	++fanoutEpoch;
+	client->markForFanout(fanoutEpoch);
+	if (includeSelf)
+		client->writeAndEnablePollOut(this, payload);
+
+	const Client::ChannelSet &joined = client->getChannels();
+	for (Client::ChannelSet::const_iterator ch = joined.begin(); ch != joined.end(); ++ch)
+	{
+		const Channel::Members &users = (*ch)->getUsers();
+		for (Channel::Members::const_iterator it = users.begin(); it != users.end(); ++it)
+		{
+			if (it->second->markForFanout(fanoutEpoch))
+				it->second->writeAndEnablePollOut(this, payload);
 		}
 	}
+	payload->release();
 }
 
 Server::~Server()
 {
+	stopWorkers();
+	for (size_t i = 0; i < shards.size(); ++i)
+	{
+		delete shards[i];
+	}
+	shards.clear();
+	for (size_t i = 0; !hub && i < workers.size(); ++i)
+	{
+		delete workers[i];
+	}
+	workers.clear();
+
+	for (std::map<unsigned long, PendingFanout>::iterator it = pendingFanouts.begin(); it != pendingFanouts.end(); ++it)
+	{
+		it->second.payload->release();
+	}
+	pendingFanouts.clear();
+
 	for (std::map<std::string, Channel *>::iterator it = channels.begin(); it != channels.end(); ++it)
 	{
-		delete it->second;
+		channelPool.destroy(it->second);
 	}
 	channels.clear();
 
 	for (std::map<int, Client *>::iterator it = clients.begin(); it != clients.end(); ++it)
 	{
-		delete it->second;
+		clientPool.destroy(it->second);
 	}
 	clients.clear();
-
-	close(this->serverSocket);
-	std::cout << "Server socket closed." << std::endl;
-}
-
-int Server::getServerSocket() const
-{
-	return this->serverSocket;
+	LOG(NET, INFO) << "Server socket closed.";
 }
 
 int Server::getPort() const
@@ -306,14 +810,84 @@ std::map<std::string, Channel *> &Server::getChannels()
 	return this->channels;
 }
 
+Server::Stats &Server::getStats()
+{
+	return stats;
+}
+
+size_t Server::getReadBudget() const
+{
+	return readBudget;
+}
+
+size_t Server::getCommandBudget() const
+{
+	return commandBudget;
+}
+
+size_t Server::getAcceptBudget() const
+{
+	return acceptBudget;
+}
+
+size_t Server::getRingBuffers() const
+{
+	return ringBuffers;
+}
+
+unsigned long Server::getFloodBurst() const
+{
+	return floodBurstMs;
+}
+
+size_t Server::getMaxLineLength() const
+{
+	return maxLineLength;
+}
+
+const std::vector<Worker *> &Server::getWorkers() const
+{
+	return workers;
+}
+
+const std::vector<Server *> &Server::getShards() const
+{
+	return shards;
+}
+
+const Pool &Server::getClientPool() const
+{
+	return clientPool;
+}
+
+const Pool &Server::getChannelPool() const
+{
+	return channelPool;
+}
+
+const Pool &Server::getMembershipPool() const
+{
+	return membershipPool;
+}
+
+Throttle &Server::getThrottle()
+{
+	return throttle;
+}
+
+Mailbox &Server::getInbox()
+{
+	return inbox;
+}
+
 Channel *Server::createChannel(const std::string &name)
 {
 	if (channels.find(name) != channels.end())
 		return channels[name];
 
-	Channel *newChannel = new Channel(name);
+	Channel *newChannel = channelPool.create(name, membershipPool);
 	channels[name] = newChannel;
-	std::cout << "Channel " << name << " created" << std::endl;
+	LOG(CHANNEL, DEBUG) << "Channel " << name << " created";
 	return newChannel;
 }
 
@@ -330,20 +904,32 @@ void Server::removeChannel(const std::string &name)
 	std::map<std::string, Channel *>::iterator it = channels.find(name);
 	if (it != channels.end())
 	{
-		delete it->second;
+		channelPool.destroy(it->second);
 		channels.erase(it);
-		std::cout << "Channel " << name << " removed" << std::endl;
+		LOG(CHANNEL, DEBUG) << "Channel " << name << " removed";
 	}
 }
 
 Client *Server::getClientByNickname(const std::string &nickname)
 {
-	for (std::map<int, Client *>::iterator it = clients.begin(); it != clients.end(); ++it)
+	return nicknames.find(nickname);
+}
+
+void Server::changeNickname(Client *client, const std::string &nickname)
+{
+	if (!client->getNickname().empty())
+		nicknames.erase(client->getNickname());
+	nicknames.insert(nickname, client);
+	client->setNickname(nickname);
+
+	if (!client->isRegistered())
+		return;
+	for (size_t i = 0; i < shards.size(); ++i)
 	{
-		if (it->second->getNickname() == nickname)
-			return it->second;
+		Mailbox::Message *message = new Mailbox::Message(Mailbox::Message::RENAME, client->getClientFd());
+		attachIdentity(message, client);
+		shards[i]->getInbox().post(message);
 	}
-	return NULL;
 }
 
 std::string Server::getCurrentTime()
@@ -354,15 +940,82 @@ std::string Server::getCurrentTime()
 	return std::string(buf);
 }
 
+// Clients can't be removed while a fan-out may still be walking a
+// channel's member list, so the close waits for the end of the iteration.
+void Server::closeLater(Client *client, const std::string &reason)
+{
+	if (client->isClosing())
+		return;
+	client->markClosing(reason);
+	closing.push_back(client->getClientFd());
+}
+
+void Server::closePending()
+{
+	// Disconnecting one client can push its peers over their limit
+	for (size_t i = 0; i < closing.size(); ++i)
+	{
+		Client *client = findClient(closing[i]);
+		if (client && client->isClosing() && hub)
+		{
+			// Only the hub can disconnect; the shadow stays until its CLOSE
+			Mailbox::Message *message = new Mailbox::Message(Mailbox::Message::DISCONNECT, closing[i]);
+			message->text = client->getCloseReason();
+			hub->getInbox().post(message);
+		}
+		else if (client && client->isClosing())
+		{
+			LOG(NET, INFO) << "Closing client " << closing[i] << ": " << client->getCloseReason();
+			CommandExecuter::handleDisconnection(this, client, client->getCloseReason());
+		}
+	}
+	closing.clear();
+}
+
+// A client's single timer covers registration, keepalive and PONG wait
+void Server::handleTimeout(Client *client)
+{
+	if (!client->isRegistered())
+	{
+		LOG(NET, INFO) << "Client " << client->getClientFd() << " did not register in time";
+		CommandExecuter::handleDisconnection(this, client, "Registration timeout");
+		return;
+	}
+
+	unsigned long idle = timers.now() - client->getLastActivity();
+	if (client->isAwaitingPong())
+	{
+		if (idle >= pingTimeoutMs)
+		{
+			std::stringstream reason;
+			reason << "Ping timeout: " << idle / 1000 << " seconds";
+			CommandExecuter::handleDisconnection(this, client, reason.str());
+			return;
+		}
+		client->setAwaitingPong(false);
+	}
+
+	if (idle < pingIntervalMs)
+	{
+		timers.schedule(client->getTimer(), pingIntervalMs - idle);
+		return;
+	}
+
+	client->writeAndEnablePollOut(this, IRCResponse::createPing(hostname));
+	client->setAwaitingPong(true);
+	timers.schedule(client->getTimer(), pingTimeoutMs);
+}
+
 void Server::sendWelcome(Client *client)
 {
+	client->setConnectionClass(&userClass);
 	client->writeAndEnablePollOut(this, IRCResponse::createWelcome(client->getNickname(), client->getUsername(), hostname));
 	client->writeAndEnablePollOut(this, IRCResponse::createYourHost(client->getNickname(), hostname));
 	client->writeAndEnablePollOut(this, IRCResponse::createCreated(client->getNickname(), creationTime));
 	client->writeAndEnablePollOut(this, IRCResponse::createMyInfo(client->getNickname(), hostname));
 	client->writeAndEnablePollOut(this, IRCResponse::createISupport(client->getNickname()));
 
-	std::cout << "Sent welcome messages to " << client->getNickname() << std::endl;
+	LOG(COMMAND, INFO) << "Sent welcome messages to " << client->getNickname();
 }
 
 const char *Server::SocketCreationFailed::what() const throw()
@@ -0,0 +1,60 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   SharedPayload.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/23 10:12:35 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/23 10:12:35 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/SharedPayload.hpp"
+
+SharedPayload::SharedPayload(size_t length) : _length(length), _refs(1)
+{
+}
+
+SharedPayload::~SharedPayload()
+{
+}
+
+SharedPayload *SharedPayload::create(const char *data, size_t length)
+{
+	void *memory = ::operator new(sizeof(SharedPayload) + length);
+	SharedPayload *payload = new (memory) SharedPayload(length);
+	std::memcpy(static_cast<char *>(memory) + sizeof(SharedPayload), data, length);
+	return payload;
+}
+
+SharedPayload *SharedPayload::create(const std::string &data)
+{
+	return create(data.data(), data.length());
+}
+
+// Atomic because a payload queued by the hub is released by the worker
+// thread that writes it.
+void SharedPayload::retain()
+{
+	__sync_add_and_fetch(&_refs, 1);
+}
+
+void SharedPayload::release()
+{
+	if (__sync_sub_and_fetch(&_refs, 1) == 0)
+	{
+		this->~SharedPayload();
+		::operator delete(this);
+	}
+}
+
+const char *SharedPayload::data() const
+{
+	return reinterpret_cast<const char *>(this + 1);
+}
+
+size_t SharedPayload::length() const
+{
+	return _length;
+}
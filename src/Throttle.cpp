@@ -0,0 +1,228 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Throttle.cpp                                       :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/10/03 10:21:54 by soksak            #+#    #+#             */
+/*   Updated: 2025/10/03 10:21:54 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+
+#include "../includes/Throttle.hpp"
+
+bool Throttle::Address::operator==(const Address &other) const
+{
+	return std::memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+}
+
+Throttle::Entry::Entry() : connections(0), tokens(0), refilledMs(0), used(false)
+{
+	std::memset(&address, 0, sizeof(address));
+}
+
+Throttle::Throttle(const Config &config)
+	: _maxClients(config.getNumber("per_ip_max_clients", 0)),
+	  _rate(config.getNumber("per_ip_connect_rate", 0)),
+	  _burst(config.getNumber("per_ip_connect_burst", 10)),
+	  _entries(INITIAL_SLOTS), _used(0)
+{
+	if (_maxClients > 65535 || _rate > 60000 || _burst == 0 || _burst > 1000)
+		throw InvalidLimits();
+	pthread_mutex_init(&_lock, NULL);
+}
+
+Throttle::~Throttle()
+{
+	pthread_mutex_destroy(&_lock);
+}
+
+bool Throttle::isEnabled() const
+{
+	return _maxClients > 0 || _rate > 0;
+}
+
+Throttle::Verdict Throttle::admit(const Address &address)
+{
+	if (!isEnabled())
+		return ADMIT;
+
+	pthread_mutex_lock(&_lock);
+	unsigned long now = nowMs();
+	Entry *entry = find(address);
+	if (!entry)
+	{
+		if ((_used + 1) * 2 > _entries.size())
+			rebuild(now);
+		entry = &insert(address);
+		entry->tokens = _burst * TOKEN;
+		entry->refilledMs = now;
+	}
+	refill(*entry, now);
+
+	Verdict verdict = ADMIT;
+	if (_maxClients > 0 && entry->connections >= _maxClients)
+		verdict = TOO_MANY;
+	else if (_rate > 0 && entry->tokens < TOKEN)
+		verdict = TOO_FAST;
+	else
+	{
+		++entry->connections;
+		if (_rate > 0)
+			entry->tokens -= TOKEN;
+	}
+	pthread_mutex_unlock(&_lock);
+	return verdict;
+}
+
+void Throttle::release(const Address &address)
+{
+	if (!isEnabled())
+		return;
+
+	pthread_mutex_lock(&_lock);
+	Entry *entry = find(address);
+	if (entry && entry->connections > 0)
+		--entry->connections;
+	pthread_mutex_unlock(&_lock);
+}
+
+size_t Throttle::size()
+{
+	pthread_mutex_lock(&_lock);
+	size_t used = _used;
+	pthread_mutex_unlock(&_lock);
+	return used;
+}
+
+Throttle::Entry *Throttle::find(const Address &address)
+{
+	size_t mask = _entries.size() - 1;
+
+	for (size_t i = hash(address) & mask; _entries[i].used; i = (i + 1) & mask)
+	{
+		if (_entries[i].address == address)
+			return &_entries[i];
+	}
+	return NULL;
+}
+
+Throttle::Entry &Throttle::insert(const Address &address)
+{
+	size_t mask = _entries.size() - 1;
+	size_t i = hash(address) & mask;
+
+	while (_entries[i].used)
+		i = (i + 1) & mask;
+	_entries[i] = Entry();
+	_entries[i].address = address;
+	_entries[i].used = true;
+	++_used;
+	return _entries[i];
+}
+
+void Throttle::refill(Entry &entry, unsigned long nowMs) const
+{
+	unsigned long full = _burst * TOKEN;
+	unsigned long elapsed = nowMs - entry.refilledMs;
+
+	entry.refilledMs = nowMs;
+	if (_rate == 0 || entry.tokens >= full)
+	{
+		entry.tokens = full;
+		return;
+	}
+	if (elapsed > full)
+		elapsed = full;
+	entry.tokens += elapsed * _rate;
+	if (entry.tokens > full)
+		entry.tokens = full;
+}
+
+// A host with nothing open and a full bucket is indistinguishable from one
+// that was never seen, so it can be dropped.
+bool Throttle::isIdle(Entry &entry, unsigned long nowMs) const
+{
+	if (entry.connections > 0)
+		return false;
+	refill(entry, nowMs);
+	return entry.tokens >= _burst * TOKEN;
+}
+
+// Rehashing drops the idle hosts; the table grows only if the ones left
+// would still fill more than a quarter of it.
+void Throttle::rebuild(unsigned long nowMs)
+{
+	std::vector<Entry> live;
+	for (size_t i = 0; i < _entries.size(); ++i)
+	{
+		if (_entries[i].used && !isIdle(_entries[i], nowMs))
+			live.push_back(_entries[i]);
+	}
+
+	size_t slots = INITIAL_SLOTS;
+	while ((live.size() + 1) * 4 > slots)
+		slots *= 2;
+
+	_entries.assign(slots, Entry());
+	_used = 0;
+	for (size_t i = 0; i < live.size(); ++i)
+	{
+		Entry &entry = insert(live[i].address);
+		entry = live[i];
+	}
+}
+
+size_t Throttle::hash(const Address &address)
+{
+	size_t hash = 2166136261u;
+
+	for (size_t i = 0; i < sizeof(address.bytes); ++i)
+	{
+		hash ^= address.bytes[i];
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+unsigned long Throttle::nowMs()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000UL + now.tv_nsec / 1000000;
+}
+
+Throttle::Address Throttle::addressOf(const sockaddr *peer)
+{
+	Address address;
+	std::memset(&address, 0, sizeof(address));
+
+	if (peer->sa_family == AF_INET6)
+		std::memcpy(address.bytes, &reinterpret_cast<const sockaddr_in6 *>(peer)->sin6_addr, 16);
+	else if (peer->sa_family == AF_INET)
+	{
+		address.bytes[10] = 0xff;
+		address.bytes[11] = 0xff;
+		std::memcpy(address.bytes + 12, &reinterpret_cast<const sockaddr_in *>(peer)->sin_addr, 4);
+	}
+	return address;
+}
+
+std::string Throttle::format(const Address &address)
+{
+	static const unsigned char mapped[12] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff };
+	char text[INET6_ADDRSTRLEN];
+
+	if (std::memcmp(address.bytes, mapped, sizeof(mapped)) == 0)
+		inet_ntop(AF_INET, address.bytes + 12, text, sizeof(text));
+	else
+		inet_ntop(AF_INET6, address.bytes, text, sizeof(text));
+	return text;
+}
+
+const char *Throttle::InvalidLimits::what() const throw()
+{
+	return "Invalid per-IP connection limits";
+}
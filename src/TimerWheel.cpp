@@ -0,0 +1,204 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   TimerWheel.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/27 16:05:52 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/27 16:05:52 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/TimerWheel.hpp"
+
+TimerWheel::Timer::Timer() : prev(NULL), next(NULL), expires(0), client(NULL)
+{
+}
+
+bool TimerWheel::Timer::pending() const
+{
+	return next != NULL;
+}
+
+TimerWheel::TimerWheel() : _current(0), _count(0)
+{
+	for (size_t i = 0; i < ROOT_SIZE; ++i)
+		initList(_root[i]);
+	for (int level = 0; level < LEVELS - 1; ++level)
+	{
+		for (size_t i = 0; i < LEVEL_SIZE; ++i)
+			initList(_levels[level][i]);
+	}
+	initList(_expired);
+	_startMs = monotonicMs();
+	_nowMs = _startMs;
+}
+
+void TimerWheel::initList(Timer &head)
+{
+	head.prev = &head;
+	head.next = &head;
+}
+
+void TimerWheel::link(Timer &head, Timer &timer)
+{
+	timer.prev = head.prev;
+	timer.next = &head;
+	head.prev->next = &timer;
+	head.prev = &timer;
+}
+
+void TimerWheel::unlink(Timer &timer)
+{
+	timer.prev->next = timer.next;
+	timer.next->prev = timer.prev;
+	timer.prev = NULL;
+	timer.next = NULL;
+}
+
+void TimerWheel::place(Timer &timer)
+{
+	if (timer.expires < _current)
+	{
+		link(_expired, timer);
+		return;
+	}
+
+	unsigned long delta = timer.expires - _current;
+	if (delta < ROOT_SIZE)
+	{
+		link(_root[timer.expires & (ROOT_SIZE - 1)], timer);
+		return;
+	}
+	for (int level = 0; level < LEVELS - 1; ++level)
+	{
+		int shift = ROOT_BITS + (level + 1) * LEVEL_BITS;
+		if (level == LEVELS - 2 || delta < (1UL << shift))
+		{
+			size_t index = (timer.expires >> (shift - LEVEL_BITS)) & (LEVEL_SIZE - 1);
+			link(_levels[level][index], timer);
+			return;
+		}
+	}
+}
+
+// Re-files every timer of the current slot at this level one level down
+void TimerWheel::cascade(int level)
+{
+	size_t index = (_current >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SIZE - 1);
+	Timer &head = _levels[level][index];
+
+	while (head.next != &head)
+	{
+		Timer &timer = *head.next;
+		unlink(timer);
+		place(timer);
+	}
+	if (index == 0 && level + 1 < LEVELS - 1)
+		cascade(level + 1);
+}
+
+void TimerWheel::tick()
+{
+	size_t index = _current & (ROOT_SIZE - 1);
+
+	if (index == 0)
+		cascade(0);
+
+	Timer &head = _root[index];
+	while (head.next != &head)
+	{
+		Timer &timer = *head.next;
+		unlink(timer);
+		link(_expired, timer);
+	}
+	++_current;
+}
+
+void TimerWheel::schedule(Timer &timer, unsigned long delayMs)
+{
+	unsigned long ticks = (delayMs + TICK_MS - 1) / TICK_MS;
+
+	if (ticks > MAX_DELTA)
+		ticks = MAX_DELTA;
+	if (timer.pending())
+		cancel(timer);
+
+	timer.expires = _current + ticks;
+	place(timer);
+	++_count;
+}
+
+void TimerWheel::cancel(Timer &timer)
+{
+	if (!timer.pending())
+		return;
+	unlink(timer);
+	--_count;
+}
+
+void TimerWheel::advance()
+{
+	_nowMs = monotonicMs();
+	unsigned long target = (_nowMs - _startMs) / TICK_MS;
+
+	if (_count == 0)
+	{
+		if (_current <= target)
+			_current = target + 1;
+		return;
+	}
+	while (_current <= target)
+		tick();
+}
+
+TimerWheel::Timer *TimerWheel::popExpired()
+{
+	if (_expired.next == &_expired)
+		return NULL;
+
+	Timer *timer = _expired.next;
+	unlink(*timer);
+	--_count;
+	return timer;
+}
+
+int TimerWheel::timeoutMs() const
+{
+	if (_expired.next != &_expired)
+		return 0;
+	if (_count == 0)
+		return -1;
+
+	// Scan the first level up to the next cascade; waking on a cascade
+	// boundary with nothing due is cheap and keeps this bounded.
+	unsigned long ticks = 0;
+	size_t index = _current & (ROOT_SIZE - 1);
+	if (index != 0)
+	{
+		while (index + ticks < ROOT_SIZE && _root[index + ticks].next == &_root[index + ticks])
+			++ticks;
+	}
+
+	unsigned long dueMs = _startMs + (_current + ticks) * TICK_MS;
+	unsigned long nowMs = monotonicMs();
+	return dueMs > nowMs ? static_cast<int>(dueMs - nowMs) : 0;
+}
+
+unsigned long TimerWheel::now() const
+{
+	return _nowMs;
+}
+
+size_t TimerWheel::size() const
+{
+	return _count;
+}
+
+unsigned long TimerWheel::monotonicMs()
+{
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<unsigned long>(ts.tv_sec) * 1000 + ts.tv_nsec / 1000000;
+}
@@ -0,0 +1,834 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   Worker.cpp                                         :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: soksak <soksak@42istanbul.com.tr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2025/09/29 15:40:13 by soksak            #+#    #+#             */
+/*   Updated: 2025/09/29 15:40:13 by soksak           ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#include "../includes/Server.hpp"
+
+int Worker::nextId = 0;
+
+Worker::Stats::Stats() : readBudgetHits(0), commandBudgetHits(0), acceptRejected(0),
+	acceptThrottled(0)
+{
+}
+
+Worker::Stats Worker::Stats::snapshot()
+{
+	Stats copy;
+	copy.readBudgetHits = __sync_fetch_and_add(&readBudgetHits, 0);
+	copy.commandBudgetHits = __sync_fetch_and_add(&commandBudgetHits, 0);
+	copy.acceptRejected = __sync_fetch_and_add(&acceptRejected, 0);
+	copy.acceptThrottled = __sync_fetch_and_add(&acceptThrottled, 0);
+	return copy;
+}
+
+Worker::RingSlot::RingSlot() : generation(0), receiving(false), sending(false), heldOffset(0)
+{
+}
+
+Worker::Worker(Server *server, int index, Reactor::Backend backend, bool threaded)
+	: _server(server), _index(index), _threaded(threaded), _reactor(backend), _listenSocket(-1),
+	  _maxLineLength(server->getMaxLineLength()),
+	  _readBudget(server->getReadBudget()),
+	  _commandBudget(server->getCommandBudget()),
+	  _acceptBudget(server->getAcceptBudget()),
+	  _acceptPending(false),
+	  _reserveFd(open("/dev/null", O_RDONLY | O_CLOEXEC)),
+	  _started(false), _stopping(false), _ring(NULL)
+{
+	if (_reactor.getBackend() == Reactor::IO_URING)
+		_ring = new Ring(256, server->getRingBuffers());
+	if (_threaded && _ring)
+		_ring->pollReadable(_inbox.getFd(), ringTag(RING_INBOX, _inbox.getFd()), true);
+	else if (_threaded)
+		_reactor.add(_inbox.getFd(), NULL);
+}
+
+Worker::~Worker()
+{
+	stop();
+	delete _ring;
+	for (std::map<int, Connection *>::iterator it = _connections.begin(); it != _connections.end(); ++it)
+	{
+		close(it->second->getFd());
+		delete it->second;
+	}
+	_connections.clear();
+	if (_listenSocket >= 0)
+		close(_listenSocket);
+	if (_reserveFd >= 0)
+		close(_reserveFd);
+}
+
+void Worker::listen(int port, bool reusePort)
+{
+	_listenSocket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (_listenSocket < 0)
+		throw Server::SocketCreationFailed();
+
+	int opt = 1;
+	if (setsockopt(_listenSocket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)) < 0)
+		throw Server::SocketCreationFailed();
+	if (reusePort && setsockopt(_listenSocket, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0)
+		throw Server::SocketCreationFailed();
+
+	sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port = htons(port);
+	address.sin_addr.s_addr = INADDR_ANY;
+	_server->setNonBlocking(_listenSocket);
+
+	if (bind(_listenSocket, (struct sockaddr *)&address, sizeof(address)) < 0)
+		throw Server::SocketBindFailed();
+	if (::listen(_listenSocket, SOMAXCONN) < 0)
+		throw Server::SocketListenFailed();
+	if (_ring)
+		_ring->accept(_listenSocket, ringTag(RING_ACCEPT, _listenSocket));
+	else
+		_reactor.add(_listenSocket, NULL);
+}
+
+// The kernel has read every queued send by the time the enter returns
+int Worker::wait(int timeoutMs)
+{
+	if (!_ring)
+		return _reactor.wait(_events, timeoutMs);
+
+	int ready = _ring->wait(timeoutMs);
+	if (!_ring->hasPending())
+		_ringSends.clear();
+	return ready;
+}
+
+void Worker::dispatch()
+{
+	if (_ring)
+	{
+		Ring::Completion completion;
+		while (_ring->next(completion))
+			ringComplete(completion);
+		serviceReadyConnections();
+		return;
+	}
+
+	bool acceptPending = _acceptPending;
+	for (size_t i = 0; i < _events.size(); ++i)
+	{
+		const Reactor::Event &event = _events[i];
+
+		if (event.fd == _listenSocket)
+		{
+			if (event.readable)
+			{
+				acceptConnections();
+				acceptPending = false;
+			}
+			continue;
+		}
+		if (_threaded && event.fd == _inbox.getFd())
+		{
+			handleMailbox();
+			continue;
+		}
+
+		// Connections on the ready list are served below, once per iteration
+		if (event.readable)
+		{
+			Connection *connection = _reactor.getConnection(event.fd);
+			if (connection && !connection->isReadReady())
+				handleData(connection);
+		}
+		if (event.writable)
+		{
+			Connection *connection = _reactor.getConnection(event.fd);
+			if (connection && !connection->getSendQueue().empty())
+			{
+				LOG(NET, DEBUG) << "Sending " << connection->getSendQueue().size() << " bytes to client " << connection->getId();
+				sendToConnection(connection);
+			}
+		}
+	}
+
+	if (acceptPending)
+		acceptConnections();
+	serviceReadyConnections();
+}
+
+bool Worker::hasReadyConnections() const
+{
+	return !_readyConnections.empty() || _acceptPending;
+}
+
+// Drains the backlog up to acceptBudget connections per iteration. Level
+// triggered backends report a listener with more waiting again; under
+// edge triggering no new event would come, so it is marked pending.
+void Worker::acceptConnections()
+{
+	_acceptPending = false;
+	for (size_t accepted = 0; accepted < _acceptBudget; ++accepted)
+	{
+		sockaddr_storage peer;
+		socklen_t length = sizeof(peer);
+		int fd = accept4(_listenSocket, reinterpret_cast<sockaddr *>(&peer), &length, SOCK_NONBLOCK | SOCK_CLOEXEC);
+		if (fd >= 0)
+		{
+			Throttle::Address address = Throttle::addressOf(reinterpret_cast<sockaddr *>(&peer));
+			if (admitConnection(fd, address))
+				addConnection(fd, address);
+			continue;
+		}
+		if (errno == EINTR || errno == ECONNABORTED)
+			continue;
+		if ((errno == EMFILE || errno == ENFILE) && rejectConnection())
+			continue;
+		return;
+	}
+	_acceptPending = _reactor.isEdgeTriggered();
+}
+
+// At the descriptor limit the reserve fd is given up just long enough to
+// take one connection off the backlog and close it; otherwise the listener
+// stays readable and the loop spins on it.
+bool Worker::rejectConnection()
+{
+	if (_reserveFd < 0)
+		return false;
+	close(_reserveFd);
+
+	int fd = accept4(_listenSocket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if (fd >= 0)
+	{
+		refuse(fd, "ERROR :Server is full\r\n");
+		__sync_fetch_and_add(&_stats.acceptRejected, 1);
+		LOG(NET, WARN) << "Descriptor limit reached, connection refused";
+	}
+	_reserveFd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+	return fd >= 0;
+}
+
+// Per-IP limits are checked before anything is allocated for the socket
+bool Worker::admitConnection(int fd, const Throttle::Address &address)
+{
+	Throttle::Verdict verdict = _server->getThrottle().admit(address);
+	if (verdict == Throttle::ADMIT)
+		return true;
+
+	if (verdict == Throttle::TOO_MANY)
+		refuse(fd, "ERROR :Closing Link: Too many connections from your host\r\n");
+	else
+		refuse(fd, "ERROR :Closing Link: Reconnecting too fast\r\n");
+	__sync_fetch_and_add(&_stats.acceptThrottled, 1);
+	LOG(NET, INFO) << "Connection from " << Throttle::format(address) << " refused: "
+		<< (verdict == Throttle::TOO_MANY ? "too many connections" : "reconnecting too fast");
+	return false;
+}
+
+void Worker::refuse(int fd, const char *message)
+{
+	::send(fd, message, std::strlen(message), MSG_DONTWAIT | MSG_NOSIGNAL);
+	close(fd);
+}
+
+// With one worker the connection is the server's Client; otherwise it gets
+// a process-wide id and the hub builds its own Client from the CONNECT.
+// The CONNECT is posted last, so a failure before it only has local steps
+// to undo.
+void Worker::addConnection(int fd, const Throttle::Address &address)
+{
+	Connection *connection = NULL;
+	Mailbox::Message *message = NULL;
+
+	try
+	{
+		if (_threaded)
+		{
+			int id = __sync_add_and_fetch(&nextId, 1);
+			message = new Mailbox::Message(Mailbox::Message::CONNECT, id);
+			message->worker = _index;
+			message->backlog = Connection::Backlog::create();
+
+			connection = new Connection(fd, id);
+			connection->setBacklog(message->backlog);
+			_connections[id] = connection;
+		}
+		else
+			connection = _server->attachClient(fd, fd);
+		connection->setAddress(address);
+		_reactor.add(fd, connection);
+		// Received buffers are copied out one at a time as lines are
+		// consumed, so one of them is all the headroom the ring path needs
+		connection->getReadBuffer().setMaxLine(_maxLineLength, _ring ? Ring::BUFFER_SIZE : 0);
+		if (_ring)
+		{
+			_ring->receive(fd, ringTag(RING_RECEIVE, fd));
+			ringSlot(fd).receiving = true;
+		}
+
+		LOG(NET, INFO) << "New client connected: " << connection->getId();
+		if (message)
+			_server->getInbox().post(message);
+	}
+	catch (const std::exception &e)
+	{
+		LOG(NET, ERROR) << "Error adding client: " << fd << " - " << e.what();
+		_reactor.remove(fd);
+		if (_threaded && connection)
+		{
+			_connections.erase(connection->getId());
+			delete connection;
+		}
+		else if (connection)
+			_server->detachClient(static_cast<Client *>(connection));
+		delete message;
+		_server->getThrottle().release(address);
+		close(fd);
+	}
+}
+
+// Reads until EAGAIN, but a connection gets at most readBudget bytes and
+// commandBudget commands per loop iteration. A connection that runs out of
+// budget goes on the ready list and is picked up again next iteration.
+void Worker::handleData(Connection *connection)
+{
+	if (connection->isClosing())
+		return;
+
+	LineBuffer &readBuffer = connection->getReadBuffer();
+	size_t commandsLeft = _commandBudget;
+	size_t bytesLeft = _readBudget;
+
+	// The ring has already read the bytes; only the command budget applies,
+	// and the receive is paused until the backlog of lines is worked off.
+	if (_ring)
+	{
+		RingSlot &slot = ringSlot(connection->getFd());
+		do
+		{
+			if (!processLines(connection, commandsLeft))
+				return;
+		}
+		while (commandsLeft > 0 && ringFeed(connection, slot));
+		if (commandsLeft == 0)
+		{
+			__sync_fetch_and_add(&_stats.commandBudgetHits, 1);
+			markReadReady(connection);
+			if (slot.receiving)
+				_ring->cancel(ringTag(RING_RECEIVE, connection->getFd()));
+		}
+		else if (!slot.receiving)
+		{
+			_ring->receive(connection->getFd(), ringTag(RING_RECEIVE, connection->getFd()));
+			slot.receiving = true;
+		}
+		return;
+	}
+
+	for (;;)
+	{
+		// Lines are consumed before every read so the buffer never holds
+		// more than one partial line when the next read comes in.
+		if (!processLines(connection, commandsLeft))
+			return;
+		if (commandsLeft == 0)
+		{
+			__sync_fetch_and_add(&_stats.commandBudgetHits, 1);
+			markReadReady(connection);
+			return;
+		}
+		if (bytesLeft == 0)
+		{
+			__sync_fetch_and_add(&_stats.readBudgetHits, 1);
+			markReadReady(connection);
+			return;
+		}
+
+		ssize_t bytes_read = readBuffer.readFrom(connection->getFd(), bytesLeft);
+
+		if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+			return;
+		if (bytes_read <= 0)
+		{
+			connectionLost(connection, "Disconnected.");
+			return;
+		}
+
+		LOG(NET, DEBUG) << "Received " << bytes_read << " bytes from client " << connection->getId();
+		bytesLeft -= bytes_read;
+	}
+}
+
+// Threaded workers batch every line of one pass into a single INPUT
+bool Worker::processLines(Connection *connection, size_t &commandsLeft)
+{
+	int fd = connection->getFd();
+	LineBuffer &readBuffer = connection->getReadBuffer();
+	Mailbox::Message *input = NULL;
+	LineBuffer::Frame frame;
+	const char *line;
+	size_t length;
+
+	while (commandsLeft > 0 && (frame = readBuffer.nextLine(line, length)) != LineBuffer::NONE)
+	{
+		if (frame == LineBuffer::LINE && length == 0)
+			continue;
+		if (_threaded)
+		{
+			if (!input)
+				input = new Mailbox::Message(Mailbox::Message::INPUT, connection->getId());
+			if (frame == LineBuffer::TOO_LONG)
+				++input->overlong;
+			else
+			{
+				input->text.append(line, length);
+				input->text += '\n';
+				--commandsLeft;
+			}
+			continue;
+		}
+
+		Client *client = static_cast<Client *>(connection);
+		if (frame == LineBuffer::TOO_LONG)
+		{
+			LOG(NET, DEBUG) << "Discarding over-long line from client " << fd;
+			_server->deliverOverlong(client);
+			continue;
+		}
+		--commandsLeft;
+		_server->deliverLine(client, line, length);
+		if (_reactor.getConnection(fd) != connection || connection->isClosing())
+			return false;
+	}
+
+	if (input)
+		_server->getInbox().post(input);
+	return true;
+}
+
+void Worker::markReadReady(Connection *connection)
+{
+	if (connection->isReadReady())
+		return;
+	connection->setReadReady(true);
+	_readyConnections.push_back(connection->getFd());
+}
+
+void Worker::serviceReadyConnections()
+{
+	std::vector<int> pending;
+	pending.swap(_readyConnections);
+
+	for (size_t i = 0; i < pending.size(); ++i)
+	{
+		Connection *connection = _reactor.getConnection(pending[i]);
+		if (!connection || !connection->isReadReady())
+			continue;
+		connection->setReadReady(false);
+		handleData(connection);
+	}
+}
+
+void Worker::connectionLost(Connection *connection, const std::string &reason)
+{
+	if (!_threaded)
+	{
+		CommandExecuter::handleDisconnection(_server, static_cast<Client *>(connection), reason);
+		return;
+	}
+
+	Mailbox::Message *message = new Mailbox::Message(Mailbox::Message::DISCONNECT, connection->getId());
+	message->text = reason;
+	_server->getInbox().post(message);
+	dropConnection(connection);
+}
+
+// Ids are never reused, so anything the hub still sends to a dropped
+// connection simply finds nothing and is discarded.
+void Worker::dropConnection(Connection *connection)
+{
+	_server->getThrottle().release(connection->getAddress());
+	if (_ring)
+		ringForget(connection->getFd());
+	_reactor.remove(connection->getFd());
+	close(connection->getFd());
+	_connections.erase(connection->getId());
+	delete connection;
+}
+
+void Worker::closeConnection(Connection *connection)
+{
+	_server->getThrottle().release(connection->getAddress());
+	if (_ring)
+		ringForget(connection->getFd());
+	_reactor.remove(connection->getFd());
+	close(connection->getFd());
+}
+
+void Worker::handleMailbox()
+{
+	Mailbox::Message *message = _inbox.collect();
+
+	while (message)
+	{
+		Mailbox::Message *next = message->next;
+		std::map<int, Connection *>::iterator it = _connections.find(message->id);
+
+		if (it != _connections.end())
+		{
+			if (message->type == Mailbox::Message::OUTPUT)
+			{
+				it->second->getSendQueue().splice(message->output);
+				markDirty(it->second);
+			}
+			else if (message->type == Mailbox::Message::CLOSE)
+				dropConnection(it->second);
+		}
+		delete message;
+		message = next;
+	}
+}
+
+void Worker::markDirty(Connection *connection)
+{
+	if (connection->isDirty())
+		return;
+	connection->setDirty(true);
+	_dirtyConnections.push_back(connection->getFd());
+}
+
+void Worker::flushDirtyConnections()
+{
+	for (size_t i = 0; i < _dirtyConnections.size(); ++i)
+	{
+		Connection *connection = _reactor.getConnection(_dirtyConnections[i]);
+		if (!connection || !connection->isDirty())
+			continue;
+		connection->setDirty(false);
+		send(connection);
+	}
+	_dirtyConnections.clear();
+}
+
+// A connection still waiting for write readiness is flushed by its event
+void Worker::send(Connection *connection)
+{
+	if (_reactor.isWritable(connection->getFd()))
+		return;
+	sendToConnection(connection);
+}
+
+// Writes until the queue is empty or the kernel buffer is full; only in
+// the latter case does the socket need write readiness from the reactor.
+void Worker::sendToConnection(Connection *connection)
+{
+	if (_ring)
+	{
+		ringSend(connection);
+		return;
+	}
+
+	SendQueue &sendQueue = connection->getSendQueue();
+	long sent = 0;
+
+	while (!sendQueue.empty())
+	{
+		ssize_t bytes_sent = sendQueue.flush(connection->getFd());
+		if (bytes_sent <= 0)
+			break;
+		sent += bytes_sent;
+	}
+	if (sent > 0 && connection->getBacklog())
+		connection->getBacklog()->add(-sent);
+	_reactor.setWritable(connection->getFd(), !sendQueue.empty());
+}
+
+void Worker::run()
+{
+	while (!_stopping)
+	{
+		int ready_count = wait(hasReadyConnections() ? 0 : -1);
+		if (ready_count < 0)
+		{
+			if (errno == EINTR)
+				continue;
+			LOG(NET, ERROR) << "Worker " << _index << " stopped: " << std::strerror(errno);
+			return;
+		}
+		dispatch();
+		flushDirtyConnections();
+	}
+}
+
+Worker::RingSlot &Worker::ringSlot(int fd)
+{
+	if (static_cast<size_t>(fd) >= _ringSlots.size())
+		_ringSlots.resize(fd + 1);
+	return _ringSlots[fd];
+}
+
+// Requests are tagged with the fd and its generation, which moves on every
+// close, so completions that outlive a connection are recognised as stale
+// even once the fd has been handed to someone else.
+uint64_t Worker::ringTag(RingOp op, int fd)
+{
+	return (static_cast<uint64_t>(ringSlot(fd).generation) << 32)
+		| (static_cast<uint64_t>(fd) << 3) | op;
+}
+
+void Worker::ringComplete(const Ring::Completion &completion)
+{
+	RingOp op = static_cast<RingOp>(completion.userData & 7);
+	int fd = static_cast<int>((completion.userData >> 3) & 0x1fffffff);
+	bool current = ringSlot(fd).generation == static_cast<unsigned>(completion.userData >> 32);
+	bool more = (completion.flags & IORING_CQE_F_MORE) != 0;
+
+	switch (op)
+	{
+	case RING_CANCEL:
+		break;
+	// The ring's accept takes a descriptor before it looks at the backlog,
+	// so at the limit it fails even with nobody waiting; it is then only
+	// re-armed once the listener has something to reject.
+	case RING_ACCEPT:
+		if (completion.result >= 0)
+			ringAccepted(completion.result);
+		else if ((completion.result == -EMFILE || completion.result == -ENFILE) && !rejectConnection())
+		{
+			if (!more)
+				_ring->pollReadable(_listenSocket, ringTag(RING_LISTEN, _listenSocket), false);
+			break;
+		}
+		else if (completion.result < 0)
+			LOG(NET, WARN) << "Accept failed: " << std::strerror(-completion.result);
+		if (!more)
+			_ring->accept(_listenSocket, ringTag(RING_ACCEPT, _listenSocket));
+		break;
+	case RING_LISTEN:
+		_ring->accept(_listenSocket, ringTag(RING_ACCEPT, _listenSocket));
+		break;
+	case RING_INBOX:
+		handleMailbox();
+		if (!more)
+			_ring->pollReadable(_inbox.getFd(), ringTag(RING_INBOX, _inbox.getFd()), true);
+		break;
+	case RING_RECEIVE:
+		ringReceived(fd, current, completion);
+		break;
+	case RING_SEND:
+		if (current)
+			ringSent(_reactor.getConnection(fd), completion);
+		break;
+	case RING_WRITABLE:
+		if (current && _reactor.getConnection(fd))
+		{
+			_reactor.setWritable(fd, false);
+			sendToConnection(_reactor.getConnection(fd));
+		}
+		break;
+	}
+}
+
+// A multishot accept cannot return peer addresses, so they are looked up
+// only when the throttle needs them.
+void Worker::ringAccepted(int fd)
+{
+	Throttle::Address address;
+	std::memset(&address, 0, sizeof(address));
+
+	if (_server->getThrottle().isEnabled())
+	{
+		sockaddr_storage peer;
+		socklen_t length = sizeof(peer);
+		if (getpeername(fd, reinterpret_cast<sockaddr *>(&peer), &length) < 0)
+		{
+			close(fd);
+			return;
+		}
+		address = Throttle::addressOf(reinterpret_cast<sockaddr *>(&peer));
+		if (!admitConnection(fd, address))
+			return;
+	}
+	addConnection(fd, address);
+}
+
+// A provided buffer is held by its connection until handleData has copied
+// all of it out, and only then goes back to the ring
+void Worker::ringReceived(int fd, bool current, const Ring::Completion &completion)
+{
+	Connection *connection = current ? _reactor.getConnection(fd) : NULL;
+
+	if (completion.flags & IORING_CQE_F_BUFFER)
+	{
+		if (connection && completion.result > 0)
+			ringSlot(fd).held.push_back(completion);
+		else
+			_ring->recycle(completion);
+	}
+	if (!connection)
+		return;
+	if (!(completion.flags & IORING_CQE_F_MORE))
+		ringSlot(fd).receiving = false;
+
+	if (completion.result == 0
+		|| (completion.result < 0 && completion.result != -ENOBUFS && completion.result != -ECANCELED))
+	{
+		connectionLost(connection, "Disconnected.");
+		return;
+	}
+	if (completion.result > 0)
+		LOG(NET, DEBUG) << "Received " << completion.result << " bytes from client " << connection->getId();
+	if (!connection->isReadReady())
+		handleData(connection);
+}
+
+// Copies held bytes into the read buffer as far as it has room. Once lines
+// are consumed it always has room again, since the buffer is sized for a
+// partial line plus a whole provided buffer.
+bool Worker::ringFeed(Connection *connection, RingSlot &slot)
+{
+	LineBuffer &readBuffer = connection->getReadBuffer();
+	bool fed = false;
+
+	while (!slot.held.empty())
+	{
+		const Ring::Completion &completion = slot.held.front();
+		size_t left = completion.result - slot.heldOffset;
+		size_t copied = readBuffer.append(_ring->buffer(completion) + slot.heldOffset, left);
+		if (copied == 0)
+			break;
+		fed = true;
+		if (copied < left)
+		{
+			slot.heldOffset += copied;
+			break;
+		}
+		_ring->recycle(completion);
+		slot.held.pop_front();
+		slot.heldOffset = 0;
+	}
+	return fed;
+}
+
+// Sends are not retried until the previous one completed; one that finds
+// the socket full waits for a writability poll instead.
+void Worker::ringSend(Connection *connection)
+{
+	int fd = connection->getFd();
+	RingSlot &slot = ringSlot(fd);
+	SendQueue &sendQueue = connection->getSendQueue();
+
+	if (slot.sending || sendQueue.empty())
+		return;
+
+	_ringSends.push_back(RingSend());
+	RingSend &send = _ringSends.back();
+	std::memset(&send.message, 0, sizeof(send.message));
+	send.message.msg_iov = send.iov;
+	send.message.msg_iovlen = sendQueue.gather(send.iov, SendQueue::MAX_IOVECS);
+	_ring->sendMessage(fd, &send.message, ringTag(RING_SEND, fd));
+	slot.sending = true;
+}
+
+void Worker::ringSent(Connection *connection, const Ring::Completion &completion)
+{
+	int fd = connection->getFd();
+	ringSlot(fd).sending = false;
+
+	if (completion.result == -EAGAIN)
+	{
+		_reactor.setWritable(fd, true);
+		_ring->pollWritable(fd, ringTag(RING_WRITABLE, fd));
+		return;
+	}
+	if (completion.result <= 0)
+		return;
+
+	connection->getSendQueue().consume(completion.result);
+	if (connection->getBacklog())
+		connection->getBacklog()->add(-completion.result);
+	ringSend(connection);
+}
+
+// Anything still queued may point into this connection's send queue, so it
+// is submitted before the connection goes away. The cancels then go out
+// with the next enter; until they land the kernel holds the socket open.
+void Worker::ringForget(int fd)
+{
+	RingSlot &slot = ringSlot(fd);
+
+	if (_ring->hasPending())
+		_ring->submit();
+	if (slot.receiving)
+		_ring->cancel(ringTag(RING_RECEIVE, fd));
+	if (_reactor.isWritable(fd))
+		_ring->cancel(ringTag(RING_WRITABLE, fd));
+	for (size_t i = 0; i < slot.held.size(); ++i)
+		_ring->recycle(slot.held[i]);
+	slot.held.clear();
+	slot.heldOffset = 0;
+	++slot.generation;
+	slot.receiving = false;
+	slot.sending = false;
+}
+
+void *Worker::threadMain(void *worker)
+{
+	try
+	{
+		static_cast<Worker *>(worker)->run();
+	}
+	catch (const std::exception &e)
+	{
+		LOG(NET, ERROR) << "Worker " << static_cast<Worker *>(worker)->_index << " stopped: " << e.what();
+	}
+	return NULL;
+}
+
+void Worker::start()
+{
+	if (pthread_create(&_thread, NULL, &Worker::threadMain, this) != 0)
+		throw WorkerStartFailed();
+	_started = true;
+}
+
+void Worker::stop()
+{
+	if (!_started)
+		return;
+	_stopping = true;
+	_inbox.wake();
+	pthread_join(_thread, NULL);
+	_started = false;
+}
+
+Mailbox& Worker::getInbox()
+{
+	return _inbox;
+}
+
+Connection* Worker::getConnection(int fd) const
+{
+	return _reactor.getConnection(fd);
+}
+
+Reactor::Backend Worker::getBackend() const
+{
+	return _reactor.getBackend();
+}
+
+Worker::Stats& Worker::getStats()
+{
+	return _stats;
+}
+
+const char *Worker::WorkerStartFailed::what() const throw()
+{
+	return "Worker thread creation failed.";
+}
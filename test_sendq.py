@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""
+SendQ Test Script
+Yoğun bir kanalda okumayı durduran bir istemcinin "SendQ exceeded" ile
+atıldığını ve sunucunun bellek kullanımının (VmRSS) sınırlı kaldığını test eder.
+Sunucuyu kendisi başlatır: ./test_sendq.py [ircserv yolu]
+"""
+
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+PORT = 6697
+PASSWORD = 'test123'
+SENDQ_HARD = 65536
+ROUNDS = 200
+BATCH = 500
+# Gönderilen veri ~40 MB; RSS artışı bunun çok altında kalmalı
+RSS_LIMIT_KB = 32 * 1024
+
+def read_rss(pid):
+    """/proc/<pid>/status içinden VmRSS değerini (KB) oku"""
+    with open(f"/proc/{pid}/status") as status:
+        for line in status:
+            if line.startswith("VmRSS:"):
+                return int(line.split()[1])
+    return 0
+
+def connect(nickname, receive_buffer=None):
+    """Bağlan, kayıt ol ve #sendq kanalına katıl"""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    if receive_buffer:
+        sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, receive_buffer)
+    sock.connect(('localhost', PORT))
+    sock.sendall(f"PASS {PASSWORD}\r\nNICK {nickname}\r\nUSER {nickname} 0 * :{nickname}\r\nJOIN #sendq\r\n".encode())
+    return sock
+
+def drain(sock):
+    """Bekleyen her şeyi oku, bloklamadan"""
+    data = b""
+    try:
+        while True:
+            chunk = sock.recv(1 << 20)
+            if not chunk:
+                break
+            data += chunk
+    except BlockingIOError:
+        pass
+    return data
+
+def main():
+    binary = sys.argv[1] if len(sys.argv) > 1 else './ircserv'
+    config = tempfile.NamedTemporaryFile('w', suffix='.conf', delete=False)
+    config.write(f"user_sendq_soft = {SENDQ_HARD}\nuser_sendq_hard = {SENDQ_HARD}\n")
+    config.close()
+
+    print("🚀 SendQ Testi Başlatılıyor...")
+    server = subprocess.Popen([binary, str(PORT), PASSWORD, config.name], stdout=subprocess.DEVNULL)
+    time.sleep(0.5)
+    failed = False
+    try:
+        # Küçük alım tamponlu ve hiç okumayan istemci
+        stalled = connect("stalled", 4096)
+        time.sleep(0.2)
+        writer = connect("writer")
+        time.sleep(0.3)
+        writer.setblocking(False)
+
+        line = ("PRIVMSG #sendq :" + "x" * 400 + "\r\n").encode()
+        received = b""
+        rss_start = read_rss(server.pid)
+        rss_peak = rss_start
+        for _ in range(ROUNDS):
+            writer.setblocking(True)
+            writer.sendall(line * BATCH)
+            writer.setblocking(False)
+            received += drain(writer)
+            rss_peak = max(rss_peak, read_rss(server.pid))
+        time.sleep(0.5)
+        received += drain(writer)
+        rss_peak = max(rss_peak, read_rss(server.pid))
+
+        sent_mb = ROUNDS * BATCH * len(line) / 1e6
+        print(f"📤 Gönderildi: {sent_mb:.1f} MB")
+        print(f"📊 VmRSS: başlangıç {rss_start} KB, en yüksek {rss_peak} KB")
+
+        if b":stalled!" in received and b"QUIT :SendQ exceeded" in received:
+            print("✅ Okumayan istemci \"SendQ exceeded\" ile atıldı")
+        else:
+            print("❌ \"SendQ exceeded\" çıkışı görülmedi")
+            failed = True
+
+        if rss_peak - rss_start < RSS_LIMIT_KB:
+            print("✅ Bellek kullanımı sınırlı kaldı")
+        else:
+            print(f"❌ VmRSS {rss_peak - rss_start} KB arttı")
+            failed = True
+        stalled.close()
+        writer.close()
+    finally:
+        server.terminate()
+        server.wait()
+        os.unlink(config.name)
+
+    print("✅ Test tamamlandı" if not failed else "❌ Test başarısız")
+    sys.exit(1 if failed else 0)
+
+if __name__ == "__main__":
+    main()